@@ -4,7 +4,17 @@
 #include "ACPlayerController.h"
 #include "GameFramework/PlayerState.h"
 #include "CombatVehicle.h"
+#include "Projectile.h"
+#include "UObject/CoreNet.h"
 #include "AbilitySystemComponent.h"
+#include "AerialCombat.h"
+
+DECLARE_CYCLE_STAT(TEXT("Validate Shot"), STAT_ValidateShot, STATGROUP_AerialCombat);
+
+static TAutoConsoleVariable<bool> CVarMeasureEventPayloads(
+    TEXT("AerialCombat.MeasureEventPayloads"),
+    false,
+    TEXT("Serializes every batch of projectile and impact events a second time to count its payload bits (server)."));
 
 AACPlayerController::AACPlayerController()
 {
@@ -12,6 +22,13 @@ AACPlayerController::AACPlayerController()
     PredictionLatencyReduction = 20.0f;
     ClientBiasPct = 0.5f;
     MaxPredictionPing = 150.0f;
+    HitValidationTolerance = 50.0f;
+    FakeProjectileMaxAge = 10.0f;
+    MaxShotOriginOffset = 500.0f;
+    MaxShotAimError = 10.0f;
+    MaxShotTurnRate = 720.0f;
+    FireRateBurstTolerance = 2.0f;
+    ImpactEventCullDistance = 15000.0f;
 }
 
 void AACPlayerController::AcknowledgePossession(APawn* P)
@@ -19,6 +36,76 @@ void AACPlayerController::AcknowledgePossession(APawn* P)
     Super::AcknowledgePossession(P);
 }
 
+void AACPlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    Super::EndPlay(EndPlayReason);
+
+    // Report Lag Compensation for this Shooter
+    const int32 NumHits = LagCompensationStats.NumHitsAccepted + LagCompensationStats.NumHitsRejected;
+    if (HasAuthority() && NumHits > 0)
+    {
+        UE_LOG(LogAerialCombat, Log, TEXT("%s: %d hits accepted, %d rejected after rewind. Rewind depth avg %.3fs, max %.3fs."),
+            *GetName(), LagCompensationStats.NumHitsAccepted, LagCompensationStats.NumHitsRejected,
+            LagCompensationStats.TotalRewindDepth / FMath::Max(LagCompensationStats.NumHitsAccepted, 1), LagCompensationStats.MaxRewindDepth);
+    }
+
+    // Report Shooting Cost (Rates over the Time this Player was Shooting)
+    if (HasAuthority() && ShootingStats.NumShots > 0)
+    {
+        const double ShootingTime = FMath::Max(ShootingStats.LastShotTime - ShootingStats.FirstShotTime, 1.0);
+        UE_LOG(LogAerialCombat, Log, TEXT("%s: %d shots, %d ability activations, %d spawn data RPCs (%.1f RPCs/s, %.1f activations/s, %.2f shots per RPC)."),
+            *GetName(), ShootingStats.NumShots, ShootingStats.NumActivations, ShootingStats.NumSpawnDataRPCs,
+            ShootingStats.NumSpawnDataRPCs / ShootingTime, ShootingStats.NumActivations / ShootingTime,
+            static_cast<float>(ShootingStats.NumShots) / FMath::Max(1, ShootingStats.NumSpawnDataRPCs));
+    }
+
+    // Report Shot Validation
+    const int32 NumValidated = ShotValidationStats.NumAccepted + ShotValidationStats.GetNumRejected();
+    if (HasAuthority() && NumValidated > 0)
+    {
+        UE_LOG(LogAerialCombat, Log, TEXT("%s: %d shots accepted, %d rejected (fire rate %d, not locked in %d, origin %d, aim %d). Validation %.2fus per shot."),
+            *GetName(), ShotValidationStats.NumAccepted, ShotValidationStats.GetNumRejected(), ShotValidationStats.NumRejectedFireRate,
+            ShotValidationStats.NumRejectedNotLockedIn, ShotValidationStats.NumRejectedOrigin, ShotValidationStats.NumRejectedAim,
+            FPlatformTime::ToMilliseconds64(ShotValidationStats.TotalCycles) * 1000.0 / NumValidated);
+    }
+
+    // Report Fake Projectile Tracking
+    const FFakeProjectileTableStats& FakeStats = FakeProjectiles.GetStats();
+    if (FakeStats.NumAdded > 0)
+    {
+        UE_LOG(LogAerialCombat, Log, TEXT("%s: %d fake projectiles tracked, peak %d. %d expired (%d leaked), %d overwritten."),
+            *GetName(), FakeStats.NumAdded, FakeStats.PeakNum, FakeStats.NumExpired, FakeStats.NumLeaked, FakeStats.NumOverwritten);
+    }
+
+    // Report Owner Projectile Events (each Spawned Event is an Actor Channel that wasn't Opened)
+    if (ProjectileEventStats.NumBatches > 0)
+    {
+        UE_LOG(LogAerialCombat, Log, TEXT("%s: %s %d projectile events in %d batches, %d unmatched."),
+            *GetName(), HasAuthority() ? TEXT("Sent") : TEXT("Received"), ProjectileEventStats.NumEvents, ProjectileEventStats.NumBatches,
+            ProjectileEventStats.NumUnmatched);
+    }
+    if (ProjectileEventStats.NumMeasuredEvents > 0)
+    {
+        UE_LOG(LogAerialCombat, Log, TEXT("%s: Measured %d projectile events, %lld bytes (%.1f bits per event)."),
+            *GetName(), ProjectileEventStats.NumMeasuredEvents, (ProjectileEventStats.PayloadBits + 7) / 8,
+            static_cast<float>(ProjectileEventStats.PayloadBits) / ProjectileEventStats.NumMeasuredEvents);
+    }
+
+    // Report Impact Events (each would have been a Multicast to Everyone)
+    if (ImpactEventStats.NumBatches > 0 || ImpactEventStats.NumCulled > 0)
+    {
+        UE_LOG(LogAerialCombat, Log, TEXT("%s: %s %d impact events in %d RPCs, %d culled, %d unresolved."),
+            *GetName(), HasAuthority() ? TEXT("Sent") : TEXT("Received"), ImpactEventStats.NumEvents, ImpactEventStats.NumBatches,
+            ImpactEventStats.NumCulled, ImpactEventStats.NumUnresolved);
+    }
+    if (ImpactEventStats.NumMeasuredEvents > 0)
+    {
+        UE_LOG(LogAerialCombat, Log, TEXT("%s: Measured %d impact events, %lld bytes (%.1f bits per event)."),
+            *GetName(), ImpactEventStats.NumMeasuredEvents, (ImpactEventStats.PayloadBits + 7) / 8,
+            static_cast<float>(ImpactEventStats.PayloadBits) / ImpactEventStats.NumMeasuredEvents);
+    }
+}
+
 float AACPlayerController::GetForwardPredictionTime() const
 {
     // Divide by 1000 to convert ping from MS to S.
@@ -31,13 +118,307 @@ float AACPlayerController::GetProjectileSleepTime() const
     return 0.001f * FMath::Max(0.0f, PlayerState->ExactPing - PredictionLatencyReduction - MaxPredictionPing);
 }
 
+float AACPlayerController::GetHitRewindTime(float TargetInterpolationDelay) const
+{
+    // The Listen Server Host sees other Vehicles where they are now
+    if (!PlayerState || IsLocalController() || GetNetMode() == NM_Standalone)
+    {
+        return 0.0f;
+    }
+
+    // Remote Vehicles reach this Client half a Ping late, then get Rendered a further Interpolation Delay behind
+    const float OneWayLatency = 0.0005f * FMath::Max(0.0f, PlayerState->ExactPing - PredictionLatencyReduction);
+    return FMath::Min(OneWayLatency + TargetInterpolationDelay, 0.001f * MaxPredictionPing);
+}
+
+void AACPlayerController::RecordSpawnData(int32 NumShots)
+{
+    const double Now = GetWorld()->GetTimeSeconds();
+    if (ShootingStats.FirstShotTime < 0.0)
+    {
+        ShootingStats.FirstShotTime = Now;
+    }
+    ShootingStats.LastShotTime = Now;
+
+    ++ShootingStats.NumSpawnDataRPCs;
+    ShootingStats.NumShots += NumShots;
+}
+
+bool AACPlayerController::ValidateShot(const ACombatVehicle* Shooter, const FVector& SpawnOffset, const FRotator& SpawnRotation, float ShotAge)
+{
+    SCOPE_CYCLE_COUNTER(STAT_ValidateShot);
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+    ON_SCOPE_EXIT
+    {
+        ShotValidationStats.TotalCycles += FPlatformTime::Cycles64() - StartCycles;
+    };
+
+    if (!Shooter)
+    {
+        return false;
+    }
+
+    // When the Shot was Fired. Never before the Last Charged Shot, so Claimed Ages can't Earn Extra Tokens.
+    const double Now = GetWorld()->GetTimeSeconds();
+    const double ShotTime = FMath::Max(Now - FMath::Max(ShotAge, 0.0f), LastShotTokenTime);
+
+    // Token Bucket: Refills at the Vehicle's Fire Rate by Fire Time (Arrival Time would Punish Batched Shots),
+    // Holds a few Shots of Slack
+    const float ShotInterval = FMath::Max(Shooter->FireRate, 0.01f);
+    const float MaxTokens = 1.0f + FireRateBurstTolerance;
+    ShotTokens = ShotTokens < 0.0f ? MaxTokens : FMath::Min(MaxTokens, ShotTokens + static_cast<float>(ShotTime - LastShotTokenTime) / ShotInterval);
+    LastShotTokenTime = ShotTime;
+    if (ShotTokens < 1.0f)
+    {
+        ++ShotValidationStats.NumRejectedFireRate;
+        return false;
+    }
+
+    // Can only Shoot from the Turret
+    if (!Shooter->WasLockedInAt(ShotTime))
+    {
+        ++ShotValidationStats.NumRejectedNotLockedIn;
+        return false;
+    }
+
+    // The Offset is Relative to the Vehicle's Location when it Fired (see GetSpawnLocation), so the Shot has to
+    // Spawn near where the Server had the Turret at that Time
+    FTransform ShooterTransform = Shooter->GetActorTransform();
+    if (ShotAge > 0.0f)
+    {
+        Shooter->GetRewoundTransform(Now - ShotAge, ShooterTransform);
+    }
+    if (FVector::DistSquared(SpawnOffset, Shooter->GetTurretPivotOffset(ShooterTransform)) > FMath::Square(MaxShotOriginOffset))
+    {
+        ++ShotValidationStats.NumRejectedOrigin;
+        return false;
+    }
+
+    // The Turret Camera's Pitch is Limited (see ACombatVehicle::ToggleLockIn)
+    const FVector2D& PitchLimits = Shooter->TurretCameraPitchLimits;
+    const float ShotPitch = FRotator::NormalizeAxis(SpawnRotation.Pitch);
+    if (ShotPitch < PitchLimits.X - MaxShotAimError || ShotPitch > PitchLimits.Y + MaxShotAimError)
+    {
+        ++ShotValidationStats.NumRejectedAim;
+        return false;
+    }
+
+    // Aim can only Turn so Fast since the Last Accepted Shot
+    const FVector ShotAim = SpawnRotation.Vector();
+    if (!LastShotAim.IsZero())
+    {
+        const float MaxTurn = FMath::Min(MaxShotAimError + MaxShotTurnRate * static_cast<float>(ShotTime - LastShotAimTime), 180.0f);
+        if ((LastShotAim | ShotAim) < FMath::Cos(FMath::DegreesToRadians(MaxTurn)))
+        {
+            ++ShotValidationStats.NumRejectedAim;
+            return false;
+        }
+    }
+    LastShotAim = ShotAim;
+    LastShotAimTime = ShotTime;
+
+    ShotTokens -= 1.0f;
+    ++ShotValidationStats.NumAccepted;
+    return true;
+}
+
 uint32 AACPlayerController::GenerateNewFakeProjectileID()
 {
     const uint32 NextID = FakeProjectileIDCounter;
     
     // Increment Next ID
-    FakeProjectileIDCounter = FakeProjectileIDCounter < UINT32_MAX ? FakeProjectileIDCounter + 1 : 1;
+    FakeProjectileIDCounter = FakeProjectileIDCounter < MAX_uint16 ? FakeProjectileIDCounter + 1 : 1;
 
-    checkf(!FakeProjectiles.Contains(NextID), TEXT("Generated invalid projectile ID! ID (%i) already used. Fake projectile map size: (%i)."), NextID, FakeProjectiles.Num());
     return NextID;
 }
+
+void AACPlayerController::RegisterFakeProjectile(uint32 ProjectileId, AProjectile* Projectile)
+{
+    const double Now = GetWorld()->GetTimeSeconds();
+
+    // Drop Entries whose Projectile Event was Lost (at most once per second)
+    if (Now >= NextFakeProjectileExpiryTime)
+    {
+        FakeProjectiles.ExpireOlderThan(Now - FakeProjectileMaxAge);
+        NextFakeProjectileExpiryTime = Now + 1.0;
+    }
+
+    FakeProjectiles.Add(static_cast<uint16>(ProjectileId), Projectile, Now);
+}
+
+AProjectile* AACPlayerController::FindFakeProjectile(uint32 ProjectileId) const
+{
+    return FakeProjectiles.Find(static_cast<uint16>(ProjectileId));
+}
+
+void AACPlayerController::UnregisterFakeProjectile(uint32 ProjectileId, const AProjectile* Projectile)
+{
+    if (FakeProjectiles.Find(static_cast<uint16>(ProjectileId)) == Projectile)
+    {
+        FakeProjectiles.Remove(static_cast<uint16>(ProjectileId));
+    }
+}
+
+void AACPlayerController::QueueProjectileEvent(uint32 ProjectileId, EProjectileEventType Type, const FVector& Location)
+{
+    // Only Remote Clients have Fake Projectiles
+    if (ProjectileId == NULL_PROJECTILE_ID || IsLocalController())
+    {
+        return;
+    }
+
+    FProjectileEvent& Event = PendingProjectileEvents.AddDefaulted_GetRef();
+    Event.ProjectileId = ProjectileId;
+    Event.Type = Type;
+    Event.Location = Location;
+}
+
+void AACPlayerController::FlushProjectileEvents()
+{
+    if (PendingProjectileEvents.Num() == 0)
+    {
+        return;
+    }
+
+    // Measure what this Batch Costs on the Wire (Off by Default, it Serializes the Batch a Second Time)
+    if (CVarMeasureEventPayloads.GetValueOnGameThread())
+    {
+        FNetBitWriter PayloadWriter(nullptr, 0);
+        for (FProjectileEvent& Event : PendingProjectileEvents)
+        {
+            bool bSerialized = false;
+            Event.NetSerialize(PayloadWriter, nullptr, bSerialized);
+        }
+        ProjectileEventStats.PayloadBits += PayloadWriter.GetNumBits();
+        ProjectileEventStats.NumMeasuredEvents += PendingProjectileEvents.Num();
+    }
+
+    ++ProjectileEventStats.NumBatches;
+    ProjectileEventStats.NumEvents += PendingProjectileEvents.Num();
+
+    RPC_Client_ProjectileEvents(PendingProjectileEvents);
+    PendingProjectileEvents.Reset();
+}
+
+void AACPlayerController::RPC_Client_ProjectileEvents_Implementation(const TArray<FProjectileEvent>& Events)
+{
+    ++ProjectileEventStats.NumBatches;
+    ProjectileEventStats.NumEvents += Events.Num();
+
+    for (const FProjectileEvent& Event : Events)
+    {
+        HandleProjectileEvent(Event);
+    }
+}
+
+bool AACPlayerController::ShouldReceiveImpact(const FVector& Location) const
+{
+    const AActor* ViewTarget = GetViewTarget();
+    return !ViewTarget || FVector::DistSquared(ViewTarget->GetActorLocation(), Location) <= FMath::Square(ImpactEventCullDistance);
+}
+
+void AACPlayerController::QueueImpactEvent(const FImpactEvent& Event)
+{
+    // Listen Server Host
+    if (IsLocalController())
+    {
+        HandleImpactEvent(Event);
+        return;
+    }
+
+    PendingImpactEvents.Add(Event);
+}
+
+void AACPlayerController::FlushImpactEvents()
+{
+    if (PendingImpactEvents.Num() == 0)
+    {
+        return;
+    }
+
+    // Measure what this Batch Costs on the Wire (Off by Default, it Serializes the Batch a Second Time)
+    if (CVarMeasureEventPayloads.GetValueOnGameThread())
+    {
+        FNetBitWriter PayloadWriter(nullptr, 0);
+        for (FImpactEvent& Event : PendingImpactEvents)
+        {
+            bool bSerialized = false;
+            Event.NetSerialize(PayloadWriter, nullptr, bSerialized);
+        }
+        ImpactEventStats.PayloadBits += PayloadWriter.GetNumBits();
+        ImpactEventStats.NumMeasuredEvents += PendingImpactEvents.Num();
+    }
+
+    ++ImpactEventStats.NumBatches;
+    ImpactEventStats.NumEvents += PendingImpactEvents.Num();
+
+    RPC_Client_ImpactEvents(PendingImpactEvents);
+    PendingImpactEvents.Reset();
+}
+
+void AACPlayerController::RPC_Client_ImpactEvents_Implementation(const TArray<FImpactEvent>& Events)
+{
+    ++ImpactEventStats.NumBatches;
+    ImpactEventStats.NumEvents += Events.Num();
+
+    for (const FImpactEvent& Event : Events)
+    {
+        HandleImpactEvent(Event);
+    }
+}
+
+void AACPlayerController::HandleImpactEvent(const FImpactEvent& Event)
+{
+    ACombatVehicle* Vehicle = Cast<ACombatVehicle>(Event.Vehicle);
+    if (!Vehicle)
+    {
+        ++ImpactEventStats.NumUnresolved;
+        return;
+    }
+
+    Vehicle->ShowImpact(Event.LocalLocation, Event.LocalNormal, Event.DecalSize);
+}
+
+void AACPlayerController::HandleProjectileEvent(const FProjectileEvent& Event)
+{
+    AProjectile* FakeProjectile = FindFakeProjectile(Event.ProjectileId);
+    if (!IsValid(FakeProjectile))
+    {
+        // Fake Projectile already Hit Something Locally (or was never Spawned)
+        ++ProjectileEventStats.NumUnmatched;
+        FakeProjectiles.Remove(static_cast<uint16>(Event.ProjectileId));
+        return;
+    }
+
+    switch (Event.Type)
+    {
+    case EProjectileEventType::Spawned:
+        // Linked, Keep Flying
+        break;
+
+    case EProjectileEventType::Impacted:
+    {
+        // Confirmed Hit, let the Fake Projectile Fly until it Reaches the Impact
+        UnregisterFakeProjectile(Event.ProjectileId, FakeProjectile);
+        const FVector ToImpact = FVector(Event.Location) - FakeProjectile->GetActorLocation();
+        const FVector Velocity = FakeProjectile->ProjectileMovement ? FakeProjectile->ProjectileMovement->Velocity : FVector::ZeroVector;
+        const float ClosingSpeed = Velocity | ToImpact.GetSafeNormal();
+        const float TimeToImpact = ClosingSpeed > UE_KINDA_SMALL_NUMBER ? ToImpact.Size() / ClosingSpeed : 0.0f;
+        if (TimeToImpact > UE_KINDA_SMALL_NUMBER && (FakeProjectile->GetLifeSpan() <= 0.0f || TimeToImpact < FakeProjectile->GetLifeSpan()))
+        {
+            FakeProjectile->SetLifeSpan(TimeToImpact);
+        }
+        else if (TimeToImpact <= UE_KINDA_SMALL_NUMBER)
+        {
+            FakeProjectile->ReleaseOrDestroy();
+        }
+        break;
+    }
+
+    case EProjectileEventType::Destroyed:
+    case EProjectileEventType::Rejected:
+        UnregisterFakeProjectile(Event.ProjectileId, FakeProjectile);
+        FakeProjectile->ReleaseOrDestroy();
+        break;
+    }
+}
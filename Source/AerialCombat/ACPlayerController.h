@@ -4,14 +4,185 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
+#include "Engine/NetSerialization.h"
+#include "UObject/CoreNet.h"
+#include "FakeProjectileTable.h"
 //#include "Projectile.h"
 #include "ACPlayerController.generated.h"
 
 // We need IDs to Identify a linked Fake and Real Projectile
+// IDs are 16-bit and Wrap Around, Skipping this one
 #define NULL_PROJECTILE_ID 0
 
 class AProjectile;
 
+UENUM()
+enum class EProjectileEventType : uint8
+{
+    Spawned, // Server Accepted the Shot, the Fake Projectile is Linked to its Authoritative Round
+    Impacted, // Authoritative Round Hit Something at Location
+    Destroyed, // Authoritative Round Expired without Hitting Anything
+    Rejected, // Server Refused the Shot (see AACPlayerController::ValidateShot)
+};
+
+/**
+ * What happened to one of a client's authoritative rounds, sent only to the shooter. Replaces replicating an
+ * authoritative projectile actor to the owning client just so it can find its fake projectile.
+ */
+USTRUCT()
+struct FProjectileEvent
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    uint32 ProjectileId = NULL_PROJECTILE_ID;
+
+    UPROPERTY()
+    EProjectileEventType Type = EProjectileEventType::Spawned;
+
+    /** Impact location. Only sent for Impacted. */
+    UPROPERTY()
+    FVector_NetQuantize Location = FVector::ZeroVector;
+
+    bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+    {
+        Ar.SerializeIntPacked(ProjectileId);
+
+        uint32 TypeBits = static_cast<uint32>(Type);
+        Ar.SerializeBits(&TypeBits, 2);
+        Type = static_cast<EProjectileEventType>(TypeBits);
+
+        bOutSuccess = true;
+        if (Type == EProjectileEventType::Impacted)
+        {
+            bOutSuccess = Location.NetSerialize(Ar, Map, bOutSuccess);
+        }
+        return true;
+    }
+};
+
+template<>
+struct TStructOpsTypeTraits<FProjectileEvent> : public TStructOpsTypeTraitsBase2<FProjectileEvent>
+{
+    enum
+    {
+        WithNetSerializer = true
+    };
+};
+
+/**
+ * A projectile impact on a vehicle, sent to every player near enough to see it. Location and normal are local to the
+ * vehicle, so the decal lands on the same spot of the client's (interpolated) copy of it.
+ */
+USTRUCT()
+struct FImpactEvent
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    TObjectPtr<AActor> Vehicle = nullptr;
+
+    UPROPERTY()
+    FVector LocalLocation = FVector::ZeroVector;
+
+    /** Surface normal at the impact, local to the vehicle. */
+    UPROPERTY()
+    FVector LocalNormal = FVector::UpVector;
+
+    UPROPERTY()
+    FVector DecalSize = FVector(10.0f);
+
+    bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+    {
+        bOutSuccess = true;
+        if (Map)
+        {
+            UObject* VehicleObject = Vehicle;
+            bOutSuccess &= Map->SerializeObject(Ar, AActor::StaticClass(), VehicleObject);
+            Vehicle = Cast<AActor>(VehicleObject);
+        }
+
+        // Millimeters within a Vehicle's Extent
+        bOutSuccess &= SerializePackedVector<10, 16>(LocalLocation, Ar);
+
+        // Normal as a Byte each of Pitch and Yaw
+        const FRotator NormalRotation = LocalNormal.Rotation();
+        uint8 Pitch = FRotator::CompressAxisToByte(NormalRotation.Pitch);
+        uint8 Yaw = FRotator::CompressAxisToByte(NormalRotation.Yaw);
+        Ar << Pitch;
+        Ar << Yaw;
+        if (Ar.IsLoading())
+        {
+            LocalNormal = FRotator(FRotator::DecompressAxisFromByte(Pitch), FRotator::DecompressAxisFromByte(Yaw), 0.0f).Vector();
+        }
+
+        bOutSuccess &= SerializePackedVector<1, 12>(DecalSize, Ar);
+        return true;
+    }
+};
+
+template<>
+struct TStructOpsTypeTraits<FImpactEvent> : public TStructOpsTypeTraitsBase2<FImpactEvent>
+{
+    enum
+    {
+        WithNetSerializer = true
+    };
+};
+
+// Impact Event Metrics (Sent on the Server, Received on the Client)
+struct FImpactEventStats
+{
+    int32 NumEvents = 0;
+    int32 NumBatches = 0;
+    int64 PayloadBits = 0; // Server: only while AerialCombat.MeasureEventPayloads is On, Excluding Vehicle References
+    int32 NumMeasuredEvents = 0; // Events in PayloadBits
+    int32 NumCulled = 0; // Server: too Far from this Player to Send
+    int32 NumUnresolved = 0; // Client: Vehicle isn't Relevant Here
+};
+
+// Server-side Shooting Cost of a Player
+struct FShootingStats
+{
+    int32 NumActivations = 0; // Shooting Ability Activations
+    int32 NumSpawnDataRPCs = 0; // Target Data Received
+    int32 NumShots = 0;
+    double FirstShotTime = -1.0;
+    double LastShotTime = 0.0;
+};
+
+// Server-side Shot Validation Metrics of a Player
+struct FShotValidationStats
+{
+    int32 NumAccepted = 0;
+    int32 NumRejectedFireRate = 0;
+    int32 NumRejectedNotLockedIn = 0;
+    int32 NumRejectedOrigin = 0;
+    int32 NumRejectedAim = 0;
+    uint64 TotalCycles = 0;
+
+    int32 GetNumRejected() const { return NumRejectedFireRate + NumRejectedNotLockedIn + NumRejectedOrigin + NumRejectedAim; }
+};
+
+// Owner Projectile Event Metrics (Sent on the Server, Received on the Client)
+struct FProjectileEventStats
+{
+    int32 NumEvents = 0;
+    int32 NumBatches = 0;
+    int64 PayloadBits = 0; // Server: only while AerialCombat.MeasureEventPayloads is On
+    int32 NumMeasuredEvents = 0; // Events in PayloadBits
+    int32 NumUnmatched = 0; // Client: Fake Projectile was already Gone
+};
+
+// Server-side Lag Compensation Metrics of a Shooter
+struct FLagCompensationStats
+{
+    int32 NumHitsAccepted = 0; // Hit at the Rewound Pose
+    int32 NumHitsRejected = 0; // Touched the Current Pose only
+    double TotalRewindDepth = 0.0; // Of Accepted Hits
+    float MaxRewindDepth = 0.0f;
+};
+
 /**
  * 
  */
@@ -27,6 +198,8 @@ public:
     // Runs on Client-Side
     virtual void AcknowledgePossession(APawn* P) override;
 
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
     //
     // Network Prediction
     //
@@ -56,22 +229,151 @@ public:
     float GetProjectileSleepTime() const;
 
 
+    //
+    // Lag Compensation
+    //
+
+    /** Extra distance (in cm) allowed between a projectile and the rewound target when validating a hit. */
+    UPROPERTY(BlueprintReadOnly, Config, Category = Network)
+    float HitValidationTolerance;
+
+    /** How far back, in seconds, to rewind a target so it matches what this client saw when it fired: one-way latency
+     * plus the target's interpolation delay, capped by MaxPredictionPing. */
+    float GetHitRewindTime(float TargetInterpolationDelay) const;
+
+    /** Hits validated for this shooter (server only). */
+    FLagCompensationStats LagCompensationStats;
+
+    /** Shooting activations, target data and shots received from this player (server only). */
+    FShootingStats ShootingStats;
+
+    /** Counts one spawn data RPC carrying NumShots shots. Server only. */
+    void RecordSpawnData(int32 NumShots);
+
+
+    //
+    // Shot Validation
+    //
+
+    /** Farthest (in cm) a client's shot may spawn from its vehicle's turret pivot, at the vehicle's rewound pose.
+     * Covers the turret camera's offset from the pivot. */
+    UPROPERTY(BlueprintReadOnly, Config, Category = Network)
+    float MaxShotOriginOffset;
+
+    /** Slack (in degrees) on the aim checks: the turret's pitch limits and its turn rate between shots. */
+    UPROPERTY(BlueprintReadOnly, Config, Category = Network)
+    float MaxShotAimError;
+
+    /** Fastest (in degrees per second) a client's aim may turn between two accepted shots. */
+    UPROPERTY(BlueprintReadOnly, Config, Category = Network)
+    float MaxShotTurnRate;
+
+    /** Shots a client may fire ahead of its vehicle's FireRate, to absorb network jitter and batching. */
+    UPROPERTY(BlueprintReadOnly, Config, Category = Network)
+    float FireRateBurstTolerance;
+
+    /** Whether a shot fired ShotAge seconds ago by this client is plausible: within FireRate (token bucket, charged at
+     * the shot's fire time), while locked in, spawned at the turret of the vehicle's rewound pose and aimed within
+     * the turret's pitch limits and turn rate. Only server-side state is checked against, except for locking in.
+     * Accepted shots use up a token. Server only. */
+    bool ValidateShot(const class ACombatVehicle* Shooter, const FVector& SpawnOffset, const FRotator& SpawnRotation, float ShotAge = 0.0f);
+
+    /** Shots validated for this player (server only). */
+    FShotValidationStats ShotValidationStats;
+
+
     //
     // Tracking Projectile IDs
     //
 
-    /** List of this client's fake projectiles (client-side predicted projectiles) that haven't been linked to an
-    * authoritative projectile yet. */
-    UPROPERTY()
-    TMap<uint32, TObjectPtr<AProjectile>> FakeProjectiles;
+    /** Fake projectile entries older than this (in seconds) are dropped, in case their projectile event was lost.
+    * Should be longer than any projectile's lifespan. */
+    UPROPERTY(BlueprintReadOnly, Config, Category = Network)
+    float FakeProjectileMaxAge;
 
-    /** Generates a unique ID for a new fake projectile. */
+    /** Generates an ID for a new fake projectile. IDs are 16-bit and wrap around. */
     uint32 GenerateNewFakeProjectileID();
 
+    /** Tracks one of this client's in-flight fake projectiles, so projectile events can find it. */
+    void RegisterFakeProjectile(uint32 ProjectileId, AProjectile* Projectile);
+
+    AProjectile* FindFakeProjectile(uint32 ProjectileId) const;
+
+    /** Stops tracking a fake projectile. Does nothing if the ID has since been reused by another projectile. */
+    void UnregisterFakeProjectile(uint32 ProjectileId, const AProjectile* Projectile);
+
+
+    //
+    // Owner Projectile Events
+    //
+
+    /** Queues an event about one of this client's rounds. Queued events go out in one RPC per frame. Server only. */
+    void QueueProjectileEvent(uint32 ProjectileId, EProjectileEventType Type, const FVector& Location = FVector::ZeroVector);
+
+    /** Sends the queued projectile events, if any. */
+    void FlushProjectileEvents();
+
+    /** Projectile events sent (server) or received (client) by this controller. */
+    FProjectileEventStats ProjectileEventStats;
+
+
+
+    //
+    // Impact Events
+    //
+
+    /** Impacts farther than this (in cm) from what this player is viewing aren't sent to them. */
+    UPROPERTY(BlueprintReadOnly, Config, Category = Network)
+    float ImpactEventCullDistance;
+
+    /** Whether an impact at Location is close enough to this player's view to send. */
+    bool ShouldReceiveImpact(const FVector& Location) const;
+
+    /** Queues an impact for this player. Queued impacts go out in one RPC per frame, a listen server host shows them
+     * right away. Server only. */
+    void QueueImpactEvent(const FImpactEvent& Event);
+
+    /** Sends the queued impact events, if any. */
+    void FlushImpactEvents();
+
+    /** Impact events sent (server) or received (client) by this controller. */
+    FImpactEventStats ImpactEventStats;
+
+protected:
+    // Events about this Client's own Rounds, Batched per Frame
+    UFUNCTION(Client, Unreliable)
+    void RPC_Client_ProjectileEvents(const TArray<FProjectileEvent>& Events);
+
+    /** Applies an event to the fake projectile it's about. */
+    void HandleProjectileEvent(const FProjectileEvent& Event);
+
+    // Impacts this Client can See, Batched per Frame
+    UFUNCTION(Client, Unreliable)
+    void RPC_Client_ImpactEvents(const TArray<FImpactEvent>& Events);
+
+    void HandleImpactEvent(const FImpactEvent& Event);
+
 
 
 private:
 
+    TArray<FProjectileEvent> PendingProjectileEvents;
+    TArray<FImpactEvent> PendingImpactEvents;
+
+    /** This client's fake projectiles (client-side predicted projectiles) that are still in flight, by ID. */
+    FFakeProjectileTable FakeProjectiles;
+
+    /** Fire rate token bucket (server only). */
+    float ShotTokens = -1.0f;
+    double LastShotTokenTime = 0.0;
+
+    /** Direction and fire time of the last accepted shot, for the turn rate check (server only). */
+    FVector LastShotAim = FVector::ZeroVector;
+    double LastShotAimTime = 0.0;
+
+    /** Next time to drop stale fake projectile entries. */
+    double NextFakeProjectileExpiryTime = 0.0;
+
     /** Internal counter for projectile IDs. Starts at 1 because 0 is reserved for non-predicted projectiles. */
-    uint32 FakeProjectileIDCounter;
+    uint16 FakeProjectileIDCounter = 1;
 };
@@ -2,6 +2,13 @@
 
 
 #include "ACPlayerState.h"
+#include "AerialCombat.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarShowASCNetStats(
+	TEXT("AerialCombat.ShowASCNetStats"),
+	false,
+	TEXT("Shows the ASC replication bytes per second of each player on screen (server)."));
 
 AACPlayerState::AACPlayerState()
 {
@@ -10,6 +17,20 @@ AACPlayerState::AACPlayerState()
 
 	AbilitySystemComponent = CreateDefaultSubobject<UCVAbilitySystemComponent>(TEXT("AbilitySystemComponent"));
 	AbilitySystemComponent->SetIsReplicated(true);
+
+	// Gameplay Effects only go to the Owner, Gameplay Cues and Tags to Everyone
+	AbilitySystemComponent->SetReplicationMode(EGameplayEffectReplicationMode::Mixed);
+
+	// Picked up by the ASC as a Default Subobject
+	AttributeSet = CreateDefaultSubobject<UCVAttributeSet>(TEXT("AttributeSet"));
+
+	// The ASC Registers its Attribute Sets, Iris only Replicates Registered Subobjects
+	bReplicateUsingRegisteredSubObjectList = true;
+
+	// Only Rolls the Stats Window
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	PrimaryActorTick.TickInterval = 1.0f;
 }
 
 void AACPlayerState::BeginPlay()
@@ -22,4 +43,59 @@ void AACPlayerState::BeginPlay()
 		Spec.ProjectileSpawnOffsetDown = 15.0f;
 		AbilitySystemComponent->GiveAbility(Spec);
     }
+
+	if (HasAuthority() && GetNetMode() != NM_Standalone)
+	{
+		ASCReplicationStats.WindowStartTime = GetWorld()->GetTimeSeconds();
+		SetActorTickEnabled(true);
+	}
+}
+
+void AACPlayerState::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// Report ASC Replication Cost of this Player
+	const FASCReplicationStats& Stats = ASCReplicationStats;
+	if (HasAuthority() && Stats.NumReplications > 0)
+	{
+		const double ReplicatingTime = FMath::Max(GetWorld()->GetTimeSeconds() - Stats.FirstReplicationTime, 1.0);
+		UE_LOG(LogAerialCombat, Log, TEXT("%s: ASC replicated %lld bytes in %d channel updates, %.1f B/s average, %.1f B/s peak."),
+			*GetPlayerName(), Stats.TotalBits / 8, Stats.NumReplications, Stats.TotalBits / 8.0 / ReplicatingTime, Stats.PeakBytesPerSecond);
+	}
+}
+
+void AACPlayerState::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	FASCReplicationStats& Stats = ASCReplicationStats;
+	const double Now = GetWorld()->GetTimeSeconds();
+	const double WindowTime = Now - Stats.WindowStartTime;
+	if (WindowTime <= 0.0)
+		return;
+
+	Stats.BytesPerSecond = Stats.WindowBits / 8.0 / WindowTime;
+	Stats.PeakBytesPerSecond = FMath::Max(Stats.PeakBytesPerSecond, Stats.BytesPerSecond);
+	Stats.WindowBits = 0;
+	Stats.WindowStartTime = Now;
+
+	// One Line per Player, Replaced every Window
+	if (CVarShowASCNetStats.GetValueOnGameThread() && GEngine)
+	{
+		GEngine->AddOnScreenDebugMessage(GetUniqueID(), PrimaryActorTick.TickInterval * 1.5f, FColor::Cyan,
+			FString::Printf(TEXT("ASC Net %s: %.1f B/s (peak %.1f)"), *GetPlayerName(), Stats.BytesPerSecond, Stats.PeakBytesPerSecond));
+	}
+}
+
+void AACPlayerState::AddReplicatedBits(int64 NumBits)
+{
+	FASCReplicationStats& Stats = ASCReplicationStats;
+	if (Stats.NumReplications == 0)
+	{
+		Stats.FirstReplicationTime = GetWorld()->GetTimeSeconds();
+	}
+	Stats.TotalBits += NumBits;
+	Stats.WindowBits += NumBits;
+	++Stats.NumReplications;
 }
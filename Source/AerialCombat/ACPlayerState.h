@@ -7,13 +7,31 @@
 
 #include "AbilitySystemInterface.h"
 #include "CVAbilitySystemComponent.h"
+#include "CVAttributeSet.h"
 
 #include "ShootingGameplayAbility.h"
 
 #include "ACPlayerState.generated.h"
 
+// Counted by the Replication Graph for the Player State's Channel: the ASC, its Attribute Set and the few
+// Player State Properties (Name, Score, Ping, Leaderboard Stats)
+struct FASCReplicationStats
+{
+	int64 TotalBits = 0; // Summed over every Connection the Player State Replicated to
+	int32 NumReplications = 0; // Channel Updates that Wrote Data
+	int64 WindowBits = 0;
+	double WindowStartTime = 0.0;
+	float BytesPerSecond = 0.0f; // Over the Last Full Window
+	float PeakBytesPerSecond = 0.0f;
+	double FirstReplicationTime = -1.0;
+};
+
 /**
- * 
+ * Owns the player's ASC and attribute set. The ASC replicates in mixed mode: gameplay effects only to the owner,
+ * gameplay cues and tags to everyone. Subobjects go through the registered subobject list (required by Iris).
+ *
+ * The server shows each player's ASC replication bytes per second with AerialCombat.ShowASCNetStats. The bits are
+ * counted per connection by UACReplicationGraph, which sees the whole channel update whatever the subobject path.
  */
 UCLASS()
 class AERIALCOMBAT_API AACPlayerState : public APlayerState
@@ -25,6 +43,13 @@ public:
 	AACPlayerState();
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Rolls the ASC Replication Window over once a Second (Server only)
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Bits Written for this Player State to one Connection (see UACReplicationGraph::ReplicateSingleActor)
+	void AddReplicatedBits(int64 NumBits);
 
 	// Leaderboard Stats
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
@@ -36,4 +61,13 @@ public:
 	// ASC
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Abilities")
 	UCVAbilitySystemComponent* AbilitySystemComponent;
+
+	// Attributes (Health) of the Possessed Vehicle, Replicated through the ASC
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Abilities")
+	UCVAttributeSet* AttributeSet;
+
+	const FASCReplicationStats& GetASCReplicationStats() const { return ASCReplicationStats; }
+
+private:
+	FASCReplicationStats ASCReplicationStats;
 };
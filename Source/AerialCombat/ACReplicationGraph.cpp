@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ACReplicationGraph.h"
+#include "ReplicationGraphTypes.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/PlayerController.h"
+
+#include "ACPlayerState.h"
+#include "CombatVehicle.h"
+#include "Projectile.h"
+
+UACReplicationGraph::UACReplicationGraph()
+{
+}
+
+void UACReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	// Explicit Policies for this Project's Classes
+	ClassRepNodePolicies.Set(AGameStateBase::StaticClass(), EACClassRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(APlayerState::StaticClass(), EACClassRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(APlayerController::StaticClass(), EACClassRepNodeMapping::NotRouted); // Handled by the Connection Node
+	ClassRepNodePolicies.Set(ACombatVehicle::StaticClass(), EACClassRepNodeMapping::Spatialize_Dynamic);
+	ClassRepNodePolicies.Set(AProjectile::StaticClass(), EACClassRepNodeMapping::NotRouted); // Local Visuals Only
+
+	// Every Replicated Native Class gets Settings (Blueprint Subclasses Inherit them)
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		UClass* Class = *It;
+		AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+		if (!ActorCDO || !ActorCDO->GetIsReplicated())
+			continue;
+
+		if (Class->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated | CLASS_NewerVersionExists) || Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_")))
+			continue;
+
+		const EACClassRepNodeMapping Mapping = GetMappingPolicy(Class);
+		ClassRepNodePolicies.Set(Class, Mapping);
+
+		const bool bSpatialize = Mapping == EACClassRepNodeMapping::Spatialize_Static || Mapping == EACClassRepNodeMapping::Spatialize_Dynamic ||
+			Mapping == EACClassRepNodeMapping::Spatialize_Dormancy;
+
+		FClassReplicationInfo ClassInfo;
+		InitClassReplicationInfo(ClassInfo, Class, bSpatialize);
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+	}
+}
+
+void UACReplicationGraph::InitGlobalGraphNodes()
+{
+	// Spatial Grid over the City
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = GridCellSize;
+	GridNode->SpatialBias = GridSpatialBias;
+	AddGlobalGraphNode(GridNode);
+
+	// Relevant to Everyone
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UACReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	// Player Controller, View Target and Owner-Routed Actors
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(ConnectionNode, RepGraphConnection);
+
+	ConnectionNodes.Add(RepGraphConnection->NetConnection, ConnectionNode);
+}
+
+void UACReplicationGraph::RemoveClientConnection(UNetConnection* NetConnection)
+{
+	ConnectionNodes.Remove(NetConnection);
+
+	Super::RemoveClientConnection(NetConnection);
+}
+
+void UACReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+	case EACClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+
+	case EACClassRepNodeMapping::Spatialize_Static:
+		GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+		break;
+
+	case EACClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+
+	case EACClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+
+	case EACClassRepNodeMapping::OwnerRelevant:
+		if (UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = FindOwnerConnectionNode(ActorInfo.GetActor()))
+		{
+			ConnectionNode->NotifyAddNetworkActor(ActorInfo);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UACReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+	case EACClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+
+	case EACClassRepNodeMapping::Spatialize_Static:
+		GridNode->RemoveActor_Static(ActorInfo);
+		break;
+
+	case EACClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+
+	case EACClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+
+	case EACClassRepNodeMapping::OwnerRelevant:
+		if (UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = FindOwnerConnectionNode(ActorInfo.GetActor()))
+		{
+			ConnectionNode->NotifyRemoveNetworkActor(ActorInfo);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+int64 UACReplicationGraph::ReplicateSingleActor(AActor* Actor, FConnectionReplicationActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalActorInfo,
+	FPerConnectionActorInfoMap& ConnectionActorInfoMap, UNetReplicationGraphConnection& ConnectionManager, const uint32 FrameNum)
+{
+	const int64 BitsWritten = Super::ReplicateSingleActor(Actor, ActorInfo, GlobalActorInfo, ConnectionActorInfoMap, ConnectionManager, FrameNum);
+
+	// The ASC is the Player State's only Replicated Component, and Changes far more often than its own Properties
+	if (BitsWritten > 0)
+	{
+		if (AACPlayerState* PlayerState = Cast<AACPlayerState>(Actor))
+		{
+			PlayerState->AddReplicatedBits(BitsWritten);
+		}
+	}
+
+	return BitsWritten;
+}
+
+void UACReplicationGraph::SetActorReplicationFrequency(AActor* Actor, float NetUpdateFrequency)
+{
+	if (FGlobalActorReplicationInfo* GlobalInfo = GlobalActorReplicationInfoMap.Find(Actor))
+	{
+		GlobalInfo->Settings.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(NetUpdateFrequency);
+	}
+}
+
+EACClassRepNodeMapping UACReplicationGraph::GetMappingPolicy(const UClass* Class) const
+{
+	if (const EACClassRepNodeMapping* Policy = ClassRepNodePolicies.Get(Class))
+	{
+		return *Policy;
+	}
+
+	// Fall back to the Actor's own Relevancy Settings
+	const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+	if (!ActorCDO || !ActorCDO->GetIsReplicated())
+	{
+		return EACClassRepNodeMapping::NotRouted;
+	}
+
+	if (ActorCDO->bAlwaysRelevant)
+	{
+		return EACClassRepNodeMapping::RelevantAllConnections;
+	}
+
+	if (ActorCDO->bOnlyRelevantToOwner)
+	{
+		return EACClassRepNodeMapping::OwnerRelevant;
+	}
+
+	// Non-Moving Actors don't need to be Re-bucketed every Frame
+	const USceneComponent* RootComponent = ActorCDO->GetRootComponent();
+	if (!ActorCDO->IsReplicatingMovement() && (!RootComponent || RootComponent->Mobility == EComponentMobility::Static))
+	{
+		return EACClassRepNodeMapping::Spatialize_Static;
+	}
+
+	return ActorCDO->NetDormancy != DORM_Never ? EACClassRepNodeMapping::Spatialize_Dormancy : EACClassRepNodeMapping::Spatialize_Dynamic;
+}
+
+void UACReplicationGraph::InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize) const
+{
+	const AActor* ActorCDO = GetDefault<AActor>(Class);
+	if (bSpatialize)
+	{
+		// Every Actor has a Cull Distance (AActor's is 150 m), so a Class still on AActor's counts as not Setting its own
+		const float ClassCullDistanceSquared = ActorCDO->GetNetCullDistanceSquared();
+		const bool bUsesEngineDefault = ClassCullDistanceSquared <= 0.0f || ClassCullDistanceSquared == GetDefault<AActor>()->GetNetCullDistanceSquared();
+		Info.SetCullDistanceSquared(bUsesEngineDefault ? FMath::Square(DefaultCullDistance) : ClassCullDistanceSquared);
+	}
+
+	Info.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(ActorCDO->GetNetUpdateFrequency());
+}
+
+UReplicationGraphNode_AlwaysRelevant_ForConnection* UACReplicationGraph::FindOwnerConnectionNode(const AActor* Actor) const
+{
+	if (!Actor)
+		return nullptr;
+
+	UNetConnection* NetConnection = Actor->GetNetConnection();
+	if (!NetConnection)
+		return nullptr;
+
+	const TObjectPtr<UReplicationGraphNode_AlwaysRelevant_ForConnection>* ConnectionNode = ConnectionNodes.Find(NetConnection);
+	return ConnectionNode ? ConnectionNode->Get() : nullptr;
+}
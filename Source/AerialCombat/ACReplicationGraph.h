@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "ACReplicationGraph.generated.h"
+
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+class UReplicationGraphNode_AlwaysRelevant_ForConnection;
+
+// How Actors of a Class are Routed into the Graph
+enum class EACClassRepNodeMapping : uint8
+{
+	NotRouted,
+	RelevantAllConnections, // Game State, Player States
+	Spatialize_Static, // Never Moves
+	Spatialize_Dynamic, // Vehicles
+	Spatialize_Dormancy, // Moves only while Awake
+	OwnerRelevant, // Only Relevant to the Owning Connection
+};
+
+/**
+ * Replication graph for the city map. Moving actors are bucketed into a 2D grid sized to the city layout, so each
+ * connection only gathers the cells around its viewer instead of considering every actor. Game and player states are
+ * relevant to everyone. Projectiles don't replicate (see UServerProjectileSubsystem).
+ *
+ * Enabled with ReplicationDriverClassName in the IpNetDriver section of DefaultEngine.ini.
+ */
+UCLASS(Transient, Config = Engine)
+class AERIALCOMBAT_API UACReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	UACReplicationGraph();
+
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RemoveClientConnection(UNetConnection* NetConnection) override;
+
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+
+	/** Also counts the bits written for each player state, for its ASC replication stats (see AACPlayerState). */
+	virtual int64 ReplicateSingleActor(AActor* Actor, FConnectionReplicationActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalActorInfo,
+		FPerConnectionActorInfoMap& ConnectionActorInfoMap, UNetReplicationGraphConnection& ConnectionManager, const uint32 FrameNum) override;
+
+	/** Graph replacement for AActor::SetNetUpdateFrequency (the graph schedules actors by frame period instead). */
+	void SetActorReplicationFrequency(AActor* Actor, float NetUpdateFrequency);
+
+	/** Size of a grid cell in cm. */
+	UPROPERTY(Config)
+	float GridCellSize = 10000.0f;
+
+	/** Lowest world X/Y covered by the grid. Actors outside still replicate, in clamped edge cells. */
+	UPROPERTY(Config)
+	FVector2D GridSpatialBias = FVector2D(-200000.0f, -200000.0f);
+
+	/** Used for spatialized classes that don't set their own cull distance, i.e. still have AActor's default (150 m). */
+	UPROPERTY(Config)
+	float DefaultCullDistance = 50000.0f;
+
+protected:
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_GridSpatialization2D> GridNode;
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_ActorList> AlwaysRelevantNode;
+
+	/** One per connection. Also holds owner-routed actors. */
+	UPROPERTY()
+	TMap<TObjectPtr<UNetConnection>, TObjectPtr<UReplicationGraphNode_AlwaysRelevant_ForConnection>> ConnectionNodes;
+
+private:
+	EACClassRepNodeMapping GetMappingPolicy(const UClass* Class) const;
+	void InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize) const;
+
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* FindOwnerConnectionNode(const AActor* Actor) const;
+
+	TClassMap<EACClassRepNodeMapping> ClassRepNodePolicies;
+};
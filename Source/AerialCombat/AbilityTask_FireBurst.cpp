@@ -0,0 +1,337 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AbilityTask_FireBurst.h"
+#include "AbilitySystemComponent.h"
+#include "AerialCombat.h"
+#include "Projectile.h"
+#include "CVAbilitySystemComponent.h"
+#include "ShootingGameplayAbility.h"
+#include "CombatVehicle.h"
+#include "ServerProjectileSubsystem.h"
+#include "TargetDataPool.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fire Burst Batch"), STAT_FireBurstBatch, STATGROUP_AerialCombat);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Burst Data Allocations"), STAT_BurstDataAllocations, STATGROUP_AerialCombat);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Burst Batches Sent"), STAT_BurstBatchesSent, STATGROUP_AerialCombat);
+
+UAbilityTask_FireBurst::UAbilityTask_FireBurst(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	bTickingTask = true;
+}
+
+UAbilityTask_FireBurst* UAbilityTask_FireBurst::FireBurst(UGameplayAbility* OwningAbility, TSubclassOf<AProjectile> ProjectileClass, float FireInterval)
+{
+	if (!ensureAlwaysMsgf(OwningAbility->GetNetExecutionPolicy() == EGameplayAbilityNetExecutionPolicy::LocalPredicted,
+		TEXT("FireBurst ability task activated in ability (%s), which does not have a net execution policy of Local Predicted."), *GetNameSafe(OwningAbility)))
+	{
+		return nullptr;
+	}
+
+	if (!ensureAlwaysMsgf(IsValid(ProjectileClass),
+		TEXT("FireBurst ability task activated in ability (%s) without a valid projectile class set."), *GetNameSafe(OwningAbility)))
+	{
+		return nullptr;
+	}
+
+	// Instantiate the Ability Task
+	UAbilityTask_FireBurst* Task = NewAbilityTask<UAbilityTask_FireBurst>(OwningAbility);
+	Task->Projectile = ProjectileClass;
+	Task->FireInterval = FMath::Max(FireInterval, 0.01f);
+
+	return Task;
+}
+
+void UAbilityTask_FireBurst::Activate()
+{
+	// Skip UAbilityTask_SpawnPredProjectile::Activate, it Fires a Single Shot
+	UAbilityTask::Activate();
+
+	if (!Ability || !Ability->GetCurrentActorInfo())
+	{
+		FinishBurst();
+		return;
+	}
+
+	const FGameplayAbilitySpecHandle& SpecHandle = GetAbilitySpecHandle();
+	const FPredictionKey& ActivationPredictionKey = GetActivationPredictionKey();
+	const bool bIsNetAuthority = Ability->GetCurrentActorInfo()->IsNetAuthority();
+
+	// Server: Receive the Client's Batches until the Final One
+	if (bIsNetAuthority && !IsLocallyControlled())
+	{
+		AbilitySystemComponent->AbilityTargetDataSetDelegate(SpecHandle, ActivationPredictionKey).AddUObject(this, &UAbilityTask_FireBurst::OnBurstDataReplicated);
+		AbilitySystemComponent->AbilityTargetDataCancelledDelegate(SpecHandle, ActivationPredictionKey).AddUObject(this, &UAbilityTask_FireBurst::FinishBurst);
+		// Batches come once per Shot or Net Frame while the Input is Held
+		bIsReceivingShots = true;
+		ServerIdleTime = 0.0f;
+		ServerIdleTimeout = FMath::Max(0.5f, 3.0f * FMath::Max(FireInterval, SendInterval));
+
+		AbilitySystemComponent->CallReplicatedTargetDataDelegatesIfSet(SpecHandle, ActivationPredictionKey);
+
+		SetWaitingOnRemotePlayerData();
+		return;
+	}
+
+	// Predicting Client or Listen Server Host: Fire until the Input is Released
+	if (IsPredictingClient())
+	{
+		ActivationPredictionKey.NewRejectedDelegate().BindUObject(this, &UAbilityTask_FireBurst::OnBurstRejected);
+	}
+	InputReleasedHandle = AbilitySystemComponent->AbilityReplicatedEventDelegate(EAbilityGenericReplicatedEvent::InputReleased, SpecHandle, ActivationPredictionKey)
+		.AddUObject(this, &UAbilityTask_FireBurst::OnFireInputReleased);
+
+	bIsFiringLocally = true;
+
+	// First Shot goes out Immediately
+	FireShot();
+	SendPendingShots(false);
+}
+
+void UAbilityTask_FireBurst::TickTask(float DeltaTime)
+{
+	Super::TickTask(DeltaTime);
+
+	// Server: a Burst whose Final Batch never Arrives would otherwise Stay Active
+	if (bIsReceivingShots)
+	{
+		ServerIdleTime += DeltaTime;
+		if (ServerIdleTime >= ServerIdleTimeout)
+		{
+			UE_LOG(LogAerialCombat, Verbose, TEXT("%s: No burst batch for %.2fs, ending the burst."), *GetNameSafe(GetAvatarActor()), ServerIdleTime);
+			FinishBurst();
+		}
+		return;
+	}
+
+	if (!bIsFiringLocally)
+		return;
+
+	FireAccumulator += DeltaTime;
+	while (FireAccumulator >= FireInterval)
+	{
+		FireAccumulator -= FireInterval;
+		FireShot();
+	}
+
+	// One Batch per Net Frame
+	SendAccumulator += DeltaTime;
+	if (SendAccumulator >= SendInterval)
+	{
+		SendAccumulator = FMath::Fmod(SendAccumulator, SendInterval);
+		SendPendingShots(false);
+	}
+}
+
+void UAbilityTask_FireBurst::FireShot()
+{
+	const APawn* Avatar = Cast<APawn>(GetAvatarActor());
+	FVector ShotLocation;
+	FRotator ShotRotation;
+	if (!UShootingGameplayAbility::GetProjectileSpawnTransform(Avatar, ShotLocation, ShotRotation))
+		return;
+
+	// Listen Server Host: Fire the Authoritative Round and Render it Locally
+	if (Ability->GetCurrentActorInfo()->IsNetAuthority())
+	{
+		FVector Velocity;
+		if (FireAuthProjectile(ShotLocation, ShotRotation, NULL_PROJECTILE_ID, 0.0f, Velocity))
+		{
+			Cast<ACombatVehicle>(GetAvatarActor())->SpawnProjectileVisual(Projectile, ShotLocation, Velocity);
+		}
+		return;
+	}
+
+	// Predicting Client: Fake Projectile now, Shot Info with the next Batch
+	AACPlayerController* PlayerCont = Cast<AACPlayerController>(Ability->GetCurrentActorInfo()->PlayerController.Get());
+	if (!PlayerCont)
+		return;
+
+	const uint32 FakeProjectileId = PlayerCont->GenerateNewFakeProjectileID();
+	if (AProjectile* NewProjectile = SpawnFakeProjectile(Projectile, ShotLocation, ShotRotation, FakeProjectileId))
+	{
+		NewProjectile->ProjectileMovement->Velocity += GetAvatarActor()->GetVelocity();
+
+		// Only Fakes still in Flight can be Rejected, Forget the Rest in a Long Burst
+		if (BurstFakeProjectiles.Num() >= MaxTrackedFakeProjectiles)
+		{
+			BurstFakeProjectiles.RemoveAllSwap([](const TPair<TWeakObjectPtr<AProjectile>, uint32>& FakeProjectile)
+			{
+				return !FakeProjectile.Key.IsValid() || FakeProjectile.Key->GetProjectileId() != FakeProjectile.Value;
+			});
+		}
+		BurstFakeProjectiles.Emplace(NewProjectile, FakeProjectileId);
+
+		FProjectileBurstShot Shot;
+		Shot.SpawnOffset = GetSpawnOffset(ShotLocation);
+		Shot.SpawnRotation = ShotRotation;
+		Shot.ProjectileId = FakeProjectileId;
+		PendingShots.Emplace(Shot, GetWorld()->GetTimeSeconds());
+	}
+
+	// Don't let a Long Frame Overflow a Batch
+	if (PendingShots.Num() >= static_cast<int32>(FGameplayAbilityTargetData_ProjectileBurst::MaxShotsPerBatch))
+	{
+		SendPendingShots(false);
+	}
+}
+
+void UAbilityTask_FireBurst::SendPendingShots(bool bFinal)
+{
+	if (PendingShots.Num() == 0 && !bFinal)
+		return;
+
+	// The Host's Shots are Already Authoritative
+	if (Ability->GetCurrentActorInfo()->IsNetAuthority())
+	{
+		PendingShots.Reset();
+		return;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// Pooled by the ASC, so a Burst doesn't Allocate per Batch
+	TTargetDataPool<FGameplayAbilityTargetData_ProjectileBurst>& Pool = CastChecked<UCVAbilitySystemComponent>(AbilitySystemComponent.Get())->GetBurstPool();
+	const int32 NumAllocations = Pool.GetNumAllocations();
+	FGameplayAbilityTargetData_ProjectileBurst* TargetData = nullptr;
+	const FGameplayAbilityTargetDataHandle& Handle = Pool.Acquire(TargetData);
+	INC_DWORD_STAT_BY(STAT_BurstDataAllocations, Pool.GetNumAllocations() - NumAllocations);
+	INC_DWORD_STAT(STAT_BurstBatchesSent);
+
+	TargetData->bFinal = bFinal;
+	TargetData->Shots.Reset();
+	for (TPair<FProjectileBurstShot, double>& PendingShot : PendingShots)
+	{
+		PendingShot.Key.AgeMs = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt((Now - PendingShot.Value) * 1000.0), 0, MAX_uint16));
+		TargetData->Shots.Add(PendingShot.Key);
+	}
+	PendingShots.Reset();
+
+	const bool bGenerateNewKey = !AbilitySystemComponent->ScopedPredictionKey.IsValidForMorePrediction();
+	FScopedPredictionWindow ScopedPrediction(AbilitySystemComponent.Get(), bGenerateNewKey);
+	AbilitySystemComponent->CallServerSetReplicatedTargetData(GetAbilitySpecHandle(), GetActivationPredictionKey(), Handle, FGameplayTag(), AbilitySystemComponent->ScopedPredictionKey);
+}
+
+void UAbilityTask_FireBurst::OnFireInputReleased()
+{
+	if (!bIsFiringLocally)
+		return;
+
+	bIsFiringLocally = false;
+	SendPendingShots(true);
+	FinishBurst();
+}
+
+void UAbilityTask_FireBurst::OnBurstRejected()
+{
+	bIsFiringLocally = false;
+	PendingShots.Reset();
+
+	AACPlayerController* PlayerCont = (Ability && Ability->GetCurrentActorInfo()) ? Cast<AACPlayerController>(Ability->GetCurrentActorInfo()->PlayerController) : nullptr;
+	for (const TPair<TWeakObjectPtr<AProjectile>, uint32>& FakeProjectile : BurstFakeProjectiles)
+	{
+		// Skip Fakes that have been Recycled for other Shots
+		if (FakeProjectile.Key.IsValid() && FakeProjectile.Key->GetProjectileId() == FakeProjectile.Value)
+		{
+			if (PlayerCont)
+			{
+				PlayerCont->UnregisterFakeProjectile(FakeProjectile.Value, FakeProjectile.Key.Get());
+			}
+			FakeProjectile.Key->ReleaseOrDestroy();
+		}
+	}
+	BurstFakeProjectiles.Reset();
+}
+
+void UAbilityTask_FireBurst::OnBurstDataReplicated(const FGameplayAbilityTargetDataHandle& Data, FGameplayTag Activation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FireBurstBatch);
+
+	ServerIdleTime = 0.0f;
+
+	// Keep the Data Alive, Consuming Clears the Cached Handle
+	const TSharedPtr<FGameplayAbilityTargetData> TargetDataRef = Data.Data.IsValidIndex(0) ? Data.Data[0] : nullptr;
+	if (!Cast<UCVAbilitySystemComponent>(AbilitySystemComponent)->TryConsumeClientReplicatedTargetData(GetAbilitySpecHandle(), GetActivationPredictionKey()))
+		return;
+
+	const FGameplayAbilityTargetData* TargetData = TargetDataRef.Get();
+	if (!TargetData || TargetData->GetScriptStruct() != FGameplayAbilityTargetData_ProjectileBurst::StaticStruct())
+	{
+		FinishBurst();
+		return;
+	}
+
+	const FGameplayAbilityTargetData_ProjectileBurst* Burst = static_cast<const FGameplayAbilityTargetData_ProjectileBurst*>(TargetData);
+	AACPlayerController* PlayerCont = Cast<AACPlayerController>(Ability->GetCurrentActorInfo()->PlayerController.Get());
+	const float ForwardPredictionTime = PlayerCont ? PlayerCont->GetForwardPredictionTime() : 0.0f;
+
+	const ACombatVehicle* Shooter = Cast<ACombatVehicle>(GetAvatarActor());
+	UServerProjectileSubsystem* ProjectileSubsystem = GetWorld()->GetSubsystem<UServerProjectileSubsystem>();
+
+	// Older Shots in the Batch have Flown Longer on the Client (Capped to a Net Frame's Worth of Shots)
+	const float MaxShotAge = FMath::Max(SendInterval, FireInterval) * 2.0f;
+	int32 NumRejected = 0;
+	for (const FProjectileBurstShot& Shot : Burst->Shots)
+	{
+		const float ShotAge = FMath::Min(Shot.AgeMs * 0.001f, MaxShotAge);
+
+		// Refused Shots only Remove their own Fake Projectile, the Burst Goes On
+		if (PlayerCont && !PlayerCont->ValidateShot(Shooter, Shot.SpawnOffset, Shot.SpawnRotation, ShotAge))
+		{
+			ProjectileSubsystem->RejectProjectile(PlayerCont, Shot.ProjectileId);
+			++NumRejected;
+			continue;
+		}
+
+		FVector Velocity;
+		FireAuthProjectile(GetSpawnLocation(Shot.SpawnOffset, ShotAge), Shot.SpawnRotation, Shot.ProjectileId, ForwardPredictionTime + ShotAge, Velocity);
+	}
+
+	if (PlayerCont)
+	{
+		PlayerCont->RecordSpawnData(Burst->Shots.Num());
+	}
+
+	// Nothing Valid at all (e.g. no Longer Locked In): End the Burst on the Client too
+	if (NumRejected > 0 && NumRejected == Burst->Shots.Num())
+	{
+		AbilitySystemComponent->ClientActivateAbilityFailed(GetAbilitySpecHandle(), GetActivationPredictionKey().Current);
+		FinishBurst();
+		return;
+	}
+
+	if (Burst->bFinal)
+	{
+		FinishBurst();
+	}
+}
+
+void UAbilityTask_FireBurst::FinishBurst()
+{
+	bIsFiringLocally = false;
+	bIsReceivingShots = false;
+
+	if (ShouldBroadcastAbilityTaskDelegates())
+	{
+		Finished.Broadcast();
+	}
+
+	EndTask();
+}
+
+void UAbilityTask_FireBurst::OnDestroy(bool bInOwnerFinished)
+{
+	if (AbilitySystemComponent.IsValid() && InputReleasedHandle.IsValid())
+	{
+		AbilitySystemComponent->AbilityReplicatedEventDelegate(EAbilityGenericReplicatedEvent::InputReleased, GetAbilitySpecHandle(), GetActivationPredictionKey()).Remove(InputReleasedHandle);
+	}
+
+	if (AbilitySystemComponent.IsValid() && AbilitySystemComponent->GetOwnerRole() == ROLE_Authority && !IsLocallyControlled())
+	{
+		AbilitySystemComponent->AbilityTargetDataSetDelegate(GetAbilitySpecHandle(), GetActivationPredictionKey()).RemoveAll(this);
+		AbilitySystemComponent->AbilityTargetDataCancelledDelegate(GetAbilitySpecHandle(), GetActivationPredictionKey()).RemoveAll(this);
+	}
+
+	Super::OnDestroy(bInOwnerFinished);
+}
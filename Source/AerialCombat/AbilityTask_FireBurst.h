@@ -0,0 +1,190 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AbilityTask_SpawnPredProjectile.h"
+
+#include "AbilityTask_FireBurst.generated.h"
+
+/**
+ * One shot of a burst, as sent to the server.
+ */
+USTRUCT()
+struct FProjectileBurstShot
+{
+    GENERATED_BODY()
+
+    /** Location the fake projectile was spawned at, relative to the avatar's location when it was fired. */
+    UPROPERTY()
+    FVector SpawnOffset = FVector::ZeroVector;
+
+    /** Rotation the fake projectile was spawned with. */
+    UPROPERTY()
+    FRotator SpawnRotation = FRotator::ZeroRotator;
+
+    /** The fake projectile's ID. */
+    UPROPERTY()
+    uint32 ProjectileId = NULL_PROJECTILE_ID;
+
+    /** How long before the batch was sent this shot was fired, in milliseconds. Shot times are only ever relative to the batch. */
+    UPROPERTY()
+    uint16 AgeMs = 0;
+};
+
+/**
+ * Target data for sustained fire. Every shot fired since the last net frame is sent together, under the burst's one
+ * ability activation.
+ */
+USTRUCT()
+struct FGameplayAbilityTargetData_ProjectileBurst : public FGameplayAbilityTargetData
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    TArray<FProjectileBurstShot> Shots;
+
+    /** Whether the fire input was released, ending the burst. */
+    UPROPERTY()
+    bool bFinal = false;
+
+    virtual UScriptStruct* GetScriptStruct() const override
+    {
+        return FGameplayAbilityTargetData_ProjectileBurst::StaticStruct();
+    }
+
+    virtual FString ToString() const override
+    {
+        return FString::Printf(TEXT("FGameplayAbilityTargetData_ProjectileBurst: (%i shots%s)"), Shots.Num(), bFinal ? TEXT(", final") : TEXT(""));
+    }
+
+    bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+    {
+        uint8 Final = bFinal ? 1 : 0;
+        Ar.SerializeBits(&Final, 1);
+        bFinal = Final != 0;
+
+        // Bounded, a Batch only Holds a Net Frame of Shots
+        uint32 NumShots = Shots.Num();
+        Ar.SerializeIntPacked(NumShots);
+        if (Ar.IsLoading())
+        {
+            if (NumShots > MaxShotsPerBatch)
+            {
+                Ar.SetError();
+                bOutSuccess = false;
+                return false;
+            }
+            Shots.SetNum(NumShots);
+        }
+
+        // Same Compact Format as FGameplayAbilityTargetData_ProjectileSpawnInfo
+        bOutSuccess = true;
+        for (FProjectileBurstShot& Shot : Shots)
+        {
+            bOutSuccess &= SerializePackedVector<10, 20>(Shot.SpawnOffset, Ar);
+            Shot.SpawnRotation.SerializeCompressedShort(Ar);
+            Ar.SerializeIntPacked(Shot.ProjectileId);
+
+            uint32 AgeMs = Shot.AgeMs;
+            Ar.SerializeIntPacked(AgeMs);
+            Shot.AgeMs = static_cast<uint16>(FMath::Min<uint32>(AgeMs, MAX_uint16));
+        }
+
+        return true;
+    }
+
+    static constexpr uint32 MaxShotsPerBatch = 32;
+};
+
+template<>
+struct TStructOpsTypeTraits<FGameplayAbilityTargetData_ProjectileBurst> : public TStructOpsTypeTraitsBase2<FGameplayAbilityTargetData_ProjectileBurst>
+{
+    enum
+    {
+        WithNetSerializer = true
+    };
+};
+
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FFireBurstDelegate);
+
+/**
+ * Sustained fire: one ability activation that keeps firing every FireInterval until the fire input is released
+ * (see UCVAbilitySystemComponent::ReleaseAbilityInputByClass).
+ *
+ * The predicting client spawns a fake projectile per shot and sends the shots to the server in one batch per net
+ * frame, instead of activating the ability and sending target data for every shot. The server fires each shot's
+ * authoritative round, fast-forwarded by the shot's age. A listen server host fires its rounds directly.
+ */
+UCLASS()
+class AERIALCOMBAT_API UAbilityTask_FireBurst : public UAbilityTask_SpawnPredProjectile
+{
+	GENERATED_BODY()
+
+public:
+    UAbilityTask_FireBurst(const FObjectInitializer& ObjectInitializer);
+
+    /** Called on the client and server when the burst ends (input released, or the server stopped receiving batches). */
+    UPROPERTY(BlueprintAssignable)
+    FFireBurstDelegate Finished;
+
+    // Fire Projectiles until the Fire Input is Released
+    UFUNCTION(BlueprintCallable, Meta = (HidePin = "OwningAbility", DefaultToSelf = "OwningAbility", BlueprintInternalUseOnly = "True"), Category = "Ability|Tasks")
+    static UAbilityTask_FireBurst* FireBurst(UGameplayAbility* OwningAbility, TSubclassOf<AProjectile> ProjectileClass, float FireInterval);
+
+    virtual void Activate() override;
+    virtual void TickTask(float DeltaTime) override;
+
+protected:
+    virtual void OnDestroy(bool bInOwnerFinished) override;
+
+    /** Time between shots, in seconds. */
+    float FireInterval = 0.25f;
+
+    /** Time between batches sent to the server, in seconds. */
+    float SendInterval = 1.0f / 30.0f;
+
+    float FireAccumulator = 0.0f;
+    float SendAccumulator = 0.0f;
+
+    /** Whether this machine fires (the predicting client or the listen server host), rather than receiving shots. */
+    bool bIsFiringLocally = false;
+
+    /**
+     * Server: the burst ends after this long without a batch, in seconds, in case the final batch was lost or the client
+     * stopped sending. Several of the longest gaps between batches (one per shot, or per net frame).
+     */
+    float ServerIdleTimeout = 0.5f;
+
+    /** Server: time since the last batch arrived. */
+    float ServerIdleTime = 0.0f;
+
+    /** Whether this is the server receiving a remote client's shots. */
+    bool bIsReceivingShots = false;
+
+    /** Shots fired since the last batch, with the world time they were fired at. */
+    TArray<TPair<FProjectileBurstShot, double>> PendingShots;
+
+    /** Fake projectiles spawned by this burst, destroyed if the activation is rejected. */
+    TArray<TPair<TWeakObjectPtr<AProjectile>, uint32>> BurstFakeProjectiles;
+
+    static constexpr int32 MaxTrackedFakeProjectiles = 64;
+
+    /** Fires one shot from the avatar's current view point. */
+    void FireShot();
+
+    /** Sends the pending shots to the server. */
+    void SendPendingShots(bool bFinal);
+
+    void OnFireInputReleased();
+
+    UFUNCTION()
+    void OnBurstRejected();
+
+    void OnBurstDataReplicated(const FGameplayAbilityTargetDataHandle& Data, FGameplayTag Activation);
+
+    void FinishBurst();
+
+    FDelegateHandle InputReleasedHandle;
+};
@@ -6,6 +6,30 @@
 #include "GameFramework/PlayerState.h"
 #include "Projectile.h"
 #include "CVAbilitySystemComponent.h"
+#include "ProjectilePoolSubsystem.h"
+#include "ServerProjectileSubsystem.h"
+#include "CombatVehicle.h"
+#include "AerialCombat.h"
+#include "TargetDataPool.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Data Replicated"), STAT_SpawnDataReplicated, STATGROUP_AerialCombat);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Spawn Info Allocations"), STAT_SpawnInfoAllocations, STATGROUP_AerialCombat);
+
+const FGameplayAbilityTargetDataHandle& FGameplayAbilityTargetData_ProjectileSpawnInfo::MakeProjectileSpawnInfoTargetData(TTargetDataPool<FGameplayAbilityTargetData_ProjectileSpawnInfo>& Pool,
+	const FVector& SpawnOffset, const FRotator& SpawnRotation, const uint32 ProjectileId)
+{
+	const int32 NumAllocations = Pool.GetNumAllocations();
+
+	FGameplayAbilityTargetData_ProjectileSpawnInfo* TargetData = nullptr;
+	const FGameplayAbilityTargetDataHandle& Handle = Pool.Acquire(TargetData);
+	TargetData->SpawnOffset = SpawnOffset;
+	TargetData->SpawnRotation = SpawnRotation;
+	TargetData->ProjectileId = ProjectileId;
+
+	// Summed over every Sender's Pool
+	INC_DWORD_STAT_BY(STAT_SpawnInfoAllocations, Pool.GetNumAllocations() - NumAllocations);
+	return Handle;
+}
 
 FActorSpawnParameters UAbilityTask_SpawnPredProjectile::GenerateSpawnParams() const
 {
@@ -36,32 +60,47 @@ FActorSpawnParameters UAbilityTask_SpawnPredProjectile::GenerateSpawnParamsForFa
 	return Params;
 }
 
-FActorSpawnParameters UAbilityTask_SpawnPredProjectile::GenerateSpawnParamsForAuth(const uint32 ProjectileId) const
+AProjectile* UAbilityTask_SpawnPredProjectile::SpawnFakeProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& InLocation, const FRotator& InRotation, const uint32 ProjectileId) const
 {
-	FActorSpawnParameters Params = GenerateSpawnParams();
-	Params.CustomPreSpawnInitalization = [ProjectileId](AActor* Actor)
+	// Fake Projectiles are never Replicated, so they can be Recycled
+	UProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UProjectilePoolSubsystem>();
+	if (Pool && UProjectilePoolSubsystem::CanPoolProjectiles(GetWorld()))
 	{
-		// Initialize ID
-		if (AProjectile* Projectile = Cast<AProjectile>(Actor))
-		{
-			Projectile->InitProjectileId(ProjectileId);
-		}
-	};
-	return Params;
+		return Pool->AcquireProjectile(ProjectileClass, InLocation, InRotation, GenerateSpawnParamsForFake(ProjectileId));
+	}
+
+	return GetWorld()->SpawnActor<AProjectile>(ProjectileClass, InLocation, InRotation, GenerateSpawnParamsForFake(ProjectileId));
+}
+
+bool UAbilityTask_SpawnPredProjectile::FireAuthProjectile(const FVector& InLocation, const FRotator& InRotation, uint32 InProjectileId, float ForwardPredictionTime, FVector& OutVelocity) const
+{
+	ACombatVehicle* Shooter = Cast<ACombatVehicle>(GetAvatarActor());
+	UServerProjectileSubsystem* ServerProjectiles = GetWorld()->GetSubsystem<UServerProjectileSubsystem>();
+	if (!Shooter || !ServerProjectiles)
+		return false;
+
+	// Same Velocity as the Fake Projectile
+	OutVelocity = ServerProjectiles->GetLaunchVelocity(Projectile, InRotation) + Shooter->GetVelocity();
+	ServerProjectiles->FireProjectile(Projectile, InLocation, OutVelocity, Shooter, InProjectileId, ForwardPredictionTime);
+
+	// Everyone else only Renders it
+	Shooter->RPC_Multicast_SpawnProjectileVisual(Projectile, InLocation, OutVelocity);
+	return true;
 }
 
 void UAbilityTask_SpawnPredProjectile::SpawnDelayedFakeProjectile()
 {
 	if (Ability && Ability->GetCurrentActorInfo() && DelayedProjectileInfo.PlayerCont.IsValid())
 	{
-		if (AProjectile* NewProjectile = GetWorld()->SpawnActor<AProjectile>(DelayedProjectileInfo.ProjectileClass, DelayedProjectileInfo.SpawnLocation, 
-			DelayedProjectileInfo.SpawnRotation, GenerateSpawnParamsForFake(DelayedProjectileInfo.ProjectileId)))
+		if (AProjectile* NewProjectile = SpawnFakeProjectile(DelayedProjectileInfo.ProjectileClass, DelayedProjectileInfo.SpawnLocation, 
+			DelayedProjectileInfo.SpawnRotation, DelayedProjectileInfo.ProjectileId))
 		{
 			// Send Spawn Data to Server so that the Server can actually spawn an Authoritative Version
 			NewProjectile->ProjectileMovement->Velocity += GetAvatarActor()->GetVelocity();
 			SendSpawnDataToServer(SpawnLocation, SpawnRotation, DelayedProjectileInfo.ProjectileId);
 
 			SpawnedFakeProj = NewProjectile;
+			SpawnedFakeProjId = DelayedProjectileInfo.ProjectileId;
 
 			if (ShouldBroadcastAbilityTaskDelegates())
 			{
@@ -90,39 +129,63 @@ void UAbilityTask_SpawnPredProjectile::OnTaskRejected()
 {
 	AACPlayerController* PlayerCont = (Ability && Ability->GetCurrentActorInfo()) ? Cast<AACPlayerController>(Ability->GetCurrentActorInfo()->PlayerController) : nullptr;
 
-	// If we've spawned a fake projectile on the client, destroy it.
-	if (SpawnedFakeProj.IsValid())
+	// If we've spawned a fake projectile on the client (and it hasn't been recycled for another shot), destroy it.
+	if (SpawnedFakeProj.IsValid() && SpawnedFakeProj->GetProjectileId() == SpawnedFakeProjId)
 	{
 		// The fake projectile will still be lingering on the PC's list of unlinked projectiles; we need to remove it.
 		if (PlayerCont)
 		{
-			if (const uint32* Key = PlayerCont->FakeProjectiles.FindKey(SpawnedFakeProj.Get()))
-			{
-				PlayerCont->FakeProjectiles.Remove(*Key);
-			}
+			PlayerCont->UnregisterFakeProjectile(SpawnedFakeProjId, SpawnedFakeProj.Get());
 		}
 
-		SpawnedFakeProj.Get()->Destroy();
+		SpawnedFakeProj.Get()->ReleaseOrDestroy();
 	}
 
 	// If we didn't spawn the fake projectile yet (because we're waiting for a delayed spawn), cancel it.
 	GetWorld()->GetTimerManager().ClearAllTimersForObject(this);
 }
 
+FVector UAbilityTask_SpawnPredProjectile::GetSpawnOffset(const FVector& InLocation) const
+{
+	const AActor* Avatar = GetAvatarActor();
+	return Avatar ? InLocation - Avatar->GetActorLocation() : InLocation;
+}
+
+FVector UAbilityTask_SpawnPredProjectile::GetSpawnLocation(const FVector& InSpawnOffset, float Age) const
+{
+	const ACombatVehicle* Vehicle = Cast<ACombatVehicle>(GetAvatarActor());
+	if (!Vehicle)
+		return InSpawnOffset;
+
+	// Where the Avatar was when the Shot was Fired
+	FTransform RewoundTransform;
+	if (Age > 0.0f && Vehicle->GetRewoundTransform(GetWorld()->GetTimeSeconds() - Age, RewoundTransform))
+	{
+		return RewoundTransform.GetLocation() + InSpawnOffset;
+	}
+
+	return Vehicle->GetActorLocation() + InSpawnOffset;
+}
+
 void UAbilityTask_SpawnPredProjectile::SendSpawnDataToServer(const FVector& InLocation, const FRotator& InRotation, uint32 InProjectileId)
 {
 	const bool bGenerateNewKey = !AbilitySystemComponent->ScopedPredictionKey.IsValidForMorePrediction();
 
 	FScopedPredictionWindow ScopedPrediction(AbilitySystemComponent.Get(), bGenerateNewKey);
-	FGameplayAbilityTargetDataHandle Handle = FGameplayAbilityTargetData_ProjectileSpawnInfo::MakeProjectileSpawnInfoTargetData(InLocation, InRotation, InProjectileId);
+	UCVAbilitySystemComponent* CVAbilitySystemComponent = CastChecked<UCVAbilitySystemComponent>(AbilitySystemComponent.Get());
+	const FGameplayAbilityTargetDataHandle& Handle = FGameplayAbilityTargetData_ProjectileSpawnInfo::MakeProjectileSpawnInfoTargetData(CVAbilitySystemComponent->GetSpawnInfoPool(),
+		GetSpawnOffset(InLocation), InRotation, InProjectileId);
 	
 	AbilitySystemComponent->CallServerSetReplicatedTargetData(GetAbilitySpecHandle(), GetActivationPredictionKey(), Handle, FGameplayTag(), AbilitySystemComponent->ScopedPredictionKey);
 }
 
 void UAbilityTask_SpawnPredProjectile::OnSpawnDataReplicated(const FGameplayAbilityTargetDataHandle& Data, FGameplayTag Activation)
 {
-	// Copy the target data before we consume it.
-	const FGameplayAbilityTargetData* TargetData = Data.Get(0);
+	SCOPE_CYCLE_COUNTER(STAT_SpawnDataReplicated);
+
+	// Keep the target data alive, consuming it clears the cached handle.
+	const TSharedPtr<FGameplayAbilityTargetData> TargetDataRef = Data.Data.IsValidIndex(0) ? Data.Data[0] : nullptr;
+	const FGameplayAbilityTargetData* TargetData = TargetDataRef.Get();
 
 	// Consume the client's data. Ensures each server task only spawns one projectile for each client task.
 	if (!Cast<UCVAbilitySystemComponent>(AbilitySystemComponent)->TryConsumeClientReplicatedTargetData(GetAbilitySpecHandle(), GetActivationPredictionKey()))
@@ -135,33 +198,36 @@ void UAbilityTask_SpawnPredProjectile::OnSpawnDataReplicated(const FGameplayAbil
 		if (const FGameplayAbilityTargetData_ProjectileSpawnInfo* SpawnInfo = static_cast<const FGameplayAbilityTargetData_ProjectileSpawnInfo*>(TargetData))
 		{
 			AACPlayerController* PlayerCont = Ability->GetCurrentActorInfo()->PlayerController.IsValid() ? Cast<AACPlayerController>(Ability->GetCurrentActorInfo()->PlayerController.Get()) : nullptr;
-			const float ForwardPredictionTime = PlayerCont->GetForwardPredictionTime();
-
-			if (AProjectile* NewProjectile = GetWorld()->SpawnActor<AProjectile>(Projectile, SpawnInfo->SpawnLocation, SpawnInfo->SpawnRotation, GenerateSpawnParamsForAuth(SpawnInfo->ProjectileId)))
+			const float ForwardPredictionTime = PlayerCont ? PlayerCont->GetForwardPredictionTime() : 0.0f;
+			if (PlayerCont)
 			{
-				// Note that there will be a discrepancy between the server's perceived ping and the client's.
-				//
-				if (NewProjectile->ProjectileMovement)
+				PlayerCont->RecordSpawnData(1);
+
+				// Refuse Shots the Vehicle couldn't have Fired. The Activation was already Confirmed, so the Client
+				// Learns through a Projectile Event instead of the Prediction Key.
+				if (!PlayerCont->ValidateShot(Cast<ACombatVehicle>(GetAvatarActor()), SpawnInfo->SpawnOffset, SpawnInfo->SpawnRotation))
 				{
-					// Tick the actor (e.g. animations, VFX).
-					if (NewProjectile->PrimaryActorTick.IsTickFunctionEnabled())
+					GetWorld()->GetSubsystem<UServerProjectileSubsystem>()->RejectProjectile(PlayerCont, SpawnInfo->ProjectileId);
+					if (ShouldBroadcastAbilityTaskDelegates())
 					{
-						NewProjectile->TickActor(ForwardPredictionTime * NewProjectile->CustomTimeDilation, LEVELTICK_All, NewProjectile->PrimaryActorTick);
+						FailedToSpawn.Broadcast(nullptr);
 					}
 
-					// Tick the movement component (to actually move the projectile).
-					NewProjectile->ProjectileMovement->TickComponent(ForwardPredictionTime * NewProjectile->CustomTimeDilation, LEVELTICK_All, nullptr);
-					if (NewProjectile->GetLifeSpan() > 0.0f)
-					{
-						/* Since we're fast-forwarding this actor, we need to subtract the forward prediction time from
-						 * its lifespan. Clamp at 0.2 so we have enough time to replicate. */
-						NewProjectile->SetLifeSpan(FMath::Max(0.2f, NewProjectile->GetLifeSpan() - ForwardPredictionTime));
-					}
+					EndTask();
+
+					return;
 				}
+			}
 
+			/* The authoritative round is fast-forwarded to where the client's fake projectile is. Note that there will
+			 * be a discrepancy between the server's perceived ping and the client's. */
+			FVector Velocity;
+			if (FireAuthProjectile(GetSpawnLocation(SpawnInfo->SpawnOffset), SpawnInfo->SpawnRotation, SpawnInfo->ProjectileId, ForwardPredictionTime, Velocity))
+			{
+				// No Actor on the Server
 				if (ShouldBroadcastAbilityTaskDelegates())
 				{
-					Success.Broadcast(NewProjectile);
+					Success.Broadcast(nullptr);
 				}
 
 				EndTask();
@@ -282,7 +348,7 @@ void UAbilityTask_SpawnPredProjectile::Activate()
 
 				// If our ping is low enough to forward-predict (or we're on LAN), immediately spawn and initialize the fake projectile.
 				const uint32 FakeProjectileId = PlayerCont->GenerateNewFakeProjectileID();
-				if (AProjectile* NewProjectile = GetWorld()->SpawnActor<AProjectile>(Projectile, SpawnLocation, SpawnRotation, GenerateSpawnParamsForFake(FakeProjectileId)))
+				if (AProjectile* NewProjectile = SpawnFakeProjectile(Projectile, SpawnLocation, SpawnRotation, FakeProjectileId))
 				{
 					// Send Spawn Data to Server so that the Server can actually spawn an Authoritative Version
 					NewProjectile->ProjectileMovement->Velocity += GetAvatarActor()->GetVelocity();
@@ -290,6 +356,7 @@ void UAbilityTask_SpawnPredProjectile::Activate()
 
 					// Cache the projectile in case the server rejects this task, and we have to destroy it.
 					SpawnedFakeProj = NewProjectile;
+					SpawnedFakeProjId = FakeProjectileId;
 
 					if (ShouldBroadcastAbilityTaskDelegates())
 					{
@@ -302,13 +369,15 @@ void UAbilityTask_SpawnPredProjectile::Activate()
 				}
 			}
 			// Perform on Authority (Listen Server)
-			/* On listen servers or in standalone, spawn the authoritative projectile. No prediction is needed in this
-			 * case. Remote servers don't spawn authoritative actors until OnTargetDataReplicated. */
+			/* On listen servers or in standalone, fire the authoritative round. No prediction is needed in this case.
+			 * Remote servers don't fire authoritative rounds until OnTargetDataReplicated. */
 			else if (bIsNetAuthority && bShouldUseServerInfo)
 			{
-				if (AProjectile* NewProjectile = GetWorld()->SpawnActor<AProjectile>(Projectile, SpawnLocation, SpawnRotation, GenerateSpawnParams()))
+				FVector Velocity;
+				if (FireAuthProjectile(SpawnLocation, SpawnRotation, NULL_PROJECTILE_ID, 0.0f, Velocity))
 				{
-					NewProjectile->ProjectileMovement->Velocity += GetAvatarActor()->GetVelocity();
+					// The Host Renders its own Shot Locally (the Multicast Skips the Shooter)
+					AProjectile* NewProjectile = Cast<ACombatVehicle>(GetAvatarActor())->SpawnProjectileVisual(Projectile, SpawnLocation, Velocity);
 
 					if (ShouldBroadcastAbilityTaskDelegates())
 					{
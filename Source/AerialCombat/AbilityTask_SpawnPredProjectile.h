@@ -6,6 +6,7 @@
 #include "Abilities/Tasks/AbilityTask.h"
 
 #include "ACPlayerController.h"
+#include "TargetDataPool.h"
 
 #include "AbilityTask_SpawnPredProjectile.generated.h"
 
@@ -54,9 +55,9 @@ struct FGameplayAbilityTargetData_ProjectileSpawnInfo : public FGameplayAbilityT
 {
     GENERATED_BODY()
 
-    /** Location to spawn projectile at. */
+    /** Location to spawn projectile at, relative to the avatar's location (so it quantizes well). */
     UPROPERTY()
-    FVector SpawnLocation;
+    FVector SpawnOffset;
 
     /** Rotation with which to spawn projectile. */
     UPROPERTY()
@@ -67,7 +68,7 @@ struct FGameplayAbilityTargetData_ProjectileSpawnInfo : public FGameplayAbilityT
     uint32 ProjectileId;
 
     FGameplayAbilityTargetData_ProjectileSpawnInfo() :
-        SpawnLocation(ForceInit),
+        SpawnOffset(ForceInit),
         SpawnRotation(ForceInit),
         ProjectileId(0)
     {
@@ -83,28 +84,17 @@ struct FGameplayAbilityTargetData_ProjectileSpawnInfo : public FGameplayAbilityT
         return FString::Printf(TEXT("FGameplayAbilityTargetData_ProjectileSpawnInfo: (%i)"), ProjectileId);
     }
 
-    static FGameplayAbilityTargetDataHandle MakeProjectileSpawnInfoTargetData(const FVector& SpawnLocation, const FRotator& SpawnRotation, const uint32 ProjectileId)
-    {
-        // Allocate and Initialize our Target Data
-        FGameplayAbilityTargetData_ProjectileSpawnInfo* TargetData = new FGameplayAbilityTargetData_ProjectileSpawnInfo();
-        TargetData->SpawnLocation = SpawnLocation;
-        TargetData->SpawnRotation = SpawnRotation;
-        TargetData->ProjectileId = ProjectileId;
-
-        // Provide a Handle to the Heap Allocated Data
-        FGameplayAbilityTargetDataHandle Handle;
-        Handle.Data.Add(TSharedPtr<FGameplayAbilityTargetData_ProjectileSpawnInfo>(TargetData));
-        
-        return Handle;
-    }
+    /** Makes target data from an instance of the sender's pool. The handle is reused by the next call, so send it right away. */
+    static const FGameplayAbilityTargetDataHandle& MakeProjectileSpawnInfoTargetData(TTargetDataPool<FGameplayAbilityTargetData_ProjectileSpawnInfo>& Pool,
+        const FVector& SpawnOffset, const FRotator& SpawnRotation, const uint32 ProjectileId);
 
     bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
     {
-        Ar << SpawnLocation;
-        Ar << SpawnRotation;
-        Ar << ProjectileId;
+        // 0.1cm Precision, up to 524m from the Avatar
+        bOutSuccess = SerializePackedVector<10, 20>(SpawnOffset, Ar);
+        SpawnRotation.SerializeCompressedShort(Ar);
+        Ar.SerializeIntPacked(ProjectileId);
 
-        bOutSuccess = true;
         return true;
     }
 };
@@ -134,8 +124,9 @@ public:
     /**
     * Called locally when the projectile is spawned.
     *
-    * On clients, this will return the fake projectile actor. On the server, this will return the authoritative
-    * projectile actor.
+    * On clients, this will return the fake projectile actor. On listen servers, this will return the host's visual
+    * projectile. Authoritative rounds aren't actors (see UServerProjectileSubsystem), so on a server simulating a
+    * remote client's shot this will be null.
     */
     UPROPERTY(BlueprintAssignable)
     FSpawnPredictedProjectileDelegate Success;
@@ -163,13 +154,16 @@ protected:
     /** Helper to make spawn parameters for a fake projectile. */
     FActorSpawnParameters GenerateSpawnParamsForFake(const uint32 ProjectileId) const;
 
-    /** Helper to make spawn parameters for an authoritative projectile. */
-    FActorSpawnParameters GenerateSpawnParamsForAuth(const uint32 ProjectileId) const;
+    /** Spawns the fake projectile, taking it from the projectile pool when possible. */
+    AProjectile* SpawnFakeProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& InLocation, const FRotator& InRotation, const uint32 ProjectileId) const;
 
     /** The fake projectile spawned by this task on the client. Used to destroy the spawned projectile if this task is
      * rejected. */
     TWeakObjectPtr<AProjectile> SpawnedFakeProj;
 
+    /** ID of SpawnedFakeProj. Pooled projectiles are reused, so this tells whether it's still the one we spawned. */
+    uint32 SpawnedFakeProjId = NULL_PROJECTILE_ID;
+
 
     // 
     // Delayed Projectile Spawning
@@ -195,10 +189,18 @@ protected:
     // Spawning Projectile on Server
     //
 
+    /** Spawn locations travel relative to the avatar. On the server, Age rewinds the avatar to when the shot was fired. */
+    FVector GetSpawnOffset(const FVector& InLocation) const;
+    FVector GetSpawnLocation(const FVector& InSpawnOffset, float Age = 0.0f) const;
+
     /** Replicates the client's spawn data to the server, so the server can spawn the authoritative projectile. */
     void SendSpawnDataToServer(const FVector& InLocation, const FRotator& InRotation, uint32 InProjectileId);
 
-    /** Spawns the authoritative projectile on the server when the spawn data is received from the client. */
+    /** Fires the authoritative round on the server, and multicasts its visual to everyone but the shooter. Returns
+     * false if there is no vehicle to fire from. */
+    bool FireAuthProjectile(const FVector& InLocation, const FRotator& InRotation, uint32 InProjectileId, float ForwardPredictionTime, FVector& OutVelocity) const;
+
+    /** Fires the authoritative round on the server when the spawn data is received from the client. */
     void OnSpawnDataReplicated(const FGameplayAbilityTargetDataHandle& Data, FGameplayTag Activation);
 
     /** Cancels this task on the server if the client failed to spawn their version of the projectile. */
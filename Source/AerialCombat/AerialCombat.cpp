@@ -3,4 +3,6 @@
 #include "AerialCombat.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogAerialCombat);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, AerialCombat, "AerialCombat" );
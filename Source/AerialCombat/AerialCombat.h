@@ -4,3 +4,7 @@
 
 #include "CoreMinimal.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogAerialCombat, Log, All);
+
+// Profile with "stat AerialCombat"
+DECLARE_STATS_GROUP(TEXT("AerialCombat"), STATGROUP_AerialCombat, STATCAT_Advanced);
@@ -2,6 +2,9 @@
 
 
 #include "CVAbilitySystemComponent.h"
+#include "AbilityTask_SpawnPredProjectile.h"
+#include "AbilityTask_FireBurst.h"
+#include "AerialCombat.h"
 
 bool UCVAbilitySystemComponent::TryConsumeClientReplicatedTargetData(FGameplayAbilitySpecHandle AbilityHandle, FPredictionKey AbilityOriginalPredictionKey)
 {
@@ -16,3 +19,39 @@ bool UCVAbilitySystemComponent::TryConsumeClientReplicatedTargetData(FGameplayAb
     }
     return false;
 }
+
+void UCVAbilitySystemComponent::ReleaseAbilityInputByClass(TSubclassOf<UGameplayAbility> AbilityClass)
+{
+    FGameplayAbilitySpec* Spec = FindAbilitySpecFromClass(AbilityClass);
+    if (!Spec)
+    {
+        return;
+    }
+
+    Spec->InputPressed = false;
+    if (!Spec->IsActive())
+    {
+        return;
+    }
+
+    for (UGameplayAbility* Instance : Spec->GetAbilityInstances())
+    {
+        if (Instance && Instance->IsActive())
+        {
+            InvokeReplicatedEvent(EAbilityGenericReplicatedEvent::InputReleased, Spec->Handle, Instance->GetCurrentActivationInfo().GetActivationPredictionKey());
+        }
+    }
+}
+
+void UCVAbilitySystemComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    // Report Target Data Pooling (Stops Growing once a Pool is Warm)
+    if (SpawnInfoPool.GetNumAllocations() > 0 || BurstPool.GetNumAllocations() > 0)
+    {
+        UE_LOG(LogAerialCombat, Log, TEXT("%s: Target data pools allocated %d spawn info (%d sent) and %d burst (%d sent) instances."),
+            *GetNameSafe(GetOwner()), SpawnInfoPool.GetNumAllocations(), SpawnInfoPool.GetNumAcquired(),
+            BurstPool.GetNumAllocations(), BurstPool.GetNumAcquired());
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
@@ -4,8 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "AbilitySystemComponent.h"
+#include "TargetDataPool.h"
 #include "CVAbilitySystemComponent.generated.h"
 
+struct FGameplayAbilityTargetData_ProjectileSpawnInfo;
+struct FGameplayAbilityTargetData_ProjectileBurst;
+
 /**
  * 
  */
@@ -19,4 +23,18 @@ public:
 
 	/** Consumes cached TargetData from client (only TargetData) and returns whether any data was actually consumed. */
 	bool TryConsumeClientReplicatedTargetData(FGameplayAbilitySpecHandle AbilityHandle, FPredictionKey AbilityOriginalPredictionKey);
+
+	/** Releases the input of an ability activated by class (abilities activated this way have no input ID to release).
+	 * Fires the InputReleased replicated event locally for each active instance, e.g. to end sustained fire. */
+	void ReleaseAbilityInputByClass(TSubclassOf<UGameplayAbility> AbilityClass);
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Target data this predicting client sends, recycled per ASC (so players and PIE worlds never share instances). */
+	TTargetDataPool<FGameplayAbilityTargetData_ProjectileSpawnInfo>& GetSpawnInfoPool() { return SpawnInfoPool; }
+	TTargetDataPool<FGameplayAbilityTargetData_ProjectileBurst>& GetBurstPool() { return BurstPool; }
+
+private:
+	TTargetDataPool<FGameplayAbilityTargetData_ProjectileSpawnInfo> SpawnInfoPool;
+	TTargetDataPool<FGameplayAbilityTargetData_ProjectileBurst> BurstPool;
 };
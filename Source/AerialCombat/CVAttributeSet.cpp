@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CVAttributeSet.h"
+#include "GameplayEffectExtension.h"
+
+#include <Net/UnrealNetwork.h>
+#include "Net/Core/PushModel/PushModel.h"
+
+UCVAttributeSet::UCVAttributeSet()
+{
+	InitHealth(100.0f);
+	InitMaxHealth(100.0f);
+	InitDamage(0.0f);
+}
+
+void UCVAttributeSet::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	constexpr bool bUsePushModel = true;
+
+	// Always Notify, so Predicted Changes are Reconciled with the Server's Value
+	FDoRepLifetimeParams PushParams{ COND_None, REPNOTIFY_Always, bUsePushModel };
+	DOREPLIFETIME_WITH_PARAMS_FAST(UCVAttributeSet, Health, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UCVAttributeSet, MaxHealth, PushParams);
+}
+
+void UCVAttributeSet::PreAttributeBaseChange(const FGameplayAttribute& Attribute, float& NewValue) const
+{
+	Super::PreAttributeBaseChange(Attribute, NewValue);
+
+	ClampAttribute(Attribute, NewValue);
+}
+
+void UCVAttributeSet::PreAttributeChange(const FGameplayAttribute& Attribute, float& NewValue)
+{
+	Super::PreAttributeChange(Attribute, NewValue);
+
+	ClampAttribute(Attribute, NewValue);
+}
+
+void UCVAttributeSet::PostAttributeBaseChange(const FGameplayAttribute& Attribute, float OldValue, float NewValue) const
+{
+	Super::PostAttributeBaseChange(Attribute, OldValue, NewValue);
+
+	MarkAttributeDirty(Attribute);
+}
+
+void UCVAttributeSet::PostAttributeChange(const FGameplayAttribute& Attribute, float OldValue, float NewValue)
+{
+	Super::PostAttributeChange(Attribute, OldValue, NewValue);
+
+	MarkAttributeDirty(Attribute);
+
+	// The Player State Replicates Rarely when Idle, a Hit Shouldn't Wait for it
+	AActor* OwningActor = GetOwningActor();
+	if (OwningActor && OwningActor->HasAuthority() && OldValue != NewValue)
+	{
+		OwningActor->ForceNetUpdate();
+	}
+}
+
+void UCVAttributeSet::PostGameplayEffectExecute(const FGameplayEffectModCallbackData& Data)
+{
+	Super::PostGameplayEffectExecute(Data);
+
+	// Damage Only Ever Lowers Health
+	if (Data.EvaluatedData.Attribute == GetDamageAttribute())
+	{
+		const float LocalDamage = GetDamage();
+		SetDamage(0.0f);
+
+		if (LocalDamage > 0.0f)
+		{
+			SetHealth(FMath::Clamp(GetHealth() - LocalDamage, 0.0f, GetMaxHealth()));
+		}
+	}
+}
+
+void UCVAttributeSet::OnRep_Health(const FGameplayAttributeData& OldHealth)
+{
+	GAMEPLAYATTRIBUTE_REPNOTIFY(UCVAttributeSet, Health, OldHealth);
+}
+
+void UCVAttributeSet::OnRep_MaxHealth(const FGameplayAttributeData& OldMaxHealth)
+{
+	GAMEPLAYATTRIBUTE_REPNOTIFY(UCVAttributeSet, MaxHealth, OldMaxHealth);
+}
+
+void UCVAttributeSet::ClampAttribute(const FGameplayAttribute& Attribute, float& NewValue) const
+{
+	if (Attribute == GetHealthAttribute())
+	{
+		NewValue = FMath::Clamp(NewValue, 0.0f, GetMaxHealth());
+	}
+	else if (Attribute == GetMaxHealthAttribute())
+	{
+		NewValue = FMath::Max(NewValue, 1.0f);
+	}
+}
+
+void UCVAttributeSet::MarkAttributeDirty(const FGameplayAttribute& Attribute) const
+{
+	// Replicated with the Push Model
+	UCVAttributeSet* MutableThis = const_cast<UCVAttributeSet*>(this);
+	if (Attribute == GetHealthAttribute())
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(UCVAttributeSet, Health, MutableThis);
+	}
+	else if (Attribute == GetMaxHealthAttribute())
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(UCVAttributeSet, MaxHealth, MutableThis);
+	}
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AttributeSet.h"
+#include "AbilitySystemComponent.h"
+#include "CVAttributeSet.generated.h"
+
+// Getter, Setter and Initter of an Attribute, plus its FGameplayAttribute
+#define ATTRIBUTE_ACCESSORS(ClassName, PropertyName) \
+	GAMEPLAYATTRIBUTE_PROPERTY_GETTER(ClassName, PropertyName) \
+	GAMEPLAYATTRIBUTE_VALUE_GETTER(PropertyName) \
+	GAMEPLAYATTRIBUTE_VALUE_SETTER(PropertyName) \
+	GAMEPLAYATTRIBUTE_VALUE_INITTER(PropertyName)
+
+/**
+ * Attributes of a player's vehicle, owned by its AACPlayerState next to the ASC and replicated with it.
+ *
+ * Damage is a meta attribute: it is never replicated, instant gameplay effects (UDamageGameplayEffect) add to it on
+ * the server and PostGameplayEffectExecute turns it into lost Health. The vehicle reacts to Health changes through
+ * the ASC's attribute change delegate, on the server and on clients alike.
+ */
+UCLASS()
+class AERIALCOMBAT_API UCVAttributeSet : public UAttributeSet
+{
+	GENERATED_BODY()
+
+public:
+	UCVAttributeSet();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	virtual void PreAttributeBaseChange(const FGameplayAttribute& Attribute, float& NewValue) const override;
+	virtual void PostAttributeBaseChange(const FGameplayAttribute& Attribute, float OldValue, float NewValue) const override;
+	virtual void PreAttributeChange(const FGameplayAttribute& Attribute, float& NewValue) override;
+	virtual void PostAttributeChange(const FGameplayAttribute& Attribute, float OldValue, float NewValue) override;
+	virtual void PostGameplayEffectExecute(const FGameplayEffectModCallbackData& Data) override;
+
+	UPROPERTY(BlueprintReadOnly, ReplicatedUsing = OnRep_Health, Category = "Health")
+	FGameplayAttributeData Health;
+	ATTRIBUTE_ACCESSORS(UCVAttributeSet, Health)
+
+	UPROPERTY(BlueprintReadOnly, ReplicatedUsing = OnRep_MaxHealth, Category = "Health")
+	FGameplayAttributeData MaxHealth;
+	ATTRIBUTE_ACCESSORS(UCVAttributeSet, MaxHealth)
+
+	/** Incoming damage, server only. Applied to Health and reset right after each execution. */
+	UPROPERTY(BlueprintReadOnly, Category = "Health")
+	FGameplayAttributeData Damage;
+	ATTRIBUTE_ACCESSORS(UCVAttributeSet, Damage)
+
+protected:
+	UFUNCTION()
+	void OnRep_Health(const FGameplayAttributeData& OldHealth);
+
+	UFUNCTION()
+	void OnRep_MaxHealth(const FGameplayAttributeData& OldMaxHealth);
+
+	/** Keeps Health within [0, MaxHealth]. */
+	void ClampAttribute(const FGameplayAttribute& Attribute, float& NewValue) const;
+
+	void MarkAttributeDirty(const FGameplayAttribute& Attribute) const;
+};
@@ -2,6 +2,13 @@
 
 
 #include "CombatVehicle.h"
+#include "AerialCombat.h"
+#include "ACReplicationGraph.h"
+#include "Projectile.h"
+#include "ProjectilePoolSubsystem.h"
+#include "VehicleVisualsSubsystem.h"
+#include "ImpactDecalSubsystem.h"
+#include "DamageGameplayEffect.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "Components/InputComponent.h"
@@ -9,20 +16,23 @@
 #include "GameFramework/SpringArmComponent.h"
 #include "GameFramework/PlayerState.h"
 #include "AbilitySystemComponent.h"
+#include "UObject/ObjectKey.h"
 
 #include <Net/UnrealNetwork.h>
+#include "Net/Core/PushModel/PushModel.h"
 #include <Kismet/GameplayStatics.h>
 #include "Components/DecalComponent.h"
 
+DECLARE_CYCLE_STAT(TEXT("Server Apply Moves"), STAT_ServerApplyMoves, STATGROUP_AerialCombat);
+DECLARE_CYCLE_STAT(TEXT("Publish Server Stats"), STAT_PublishServerStats, STATGROUP_AerialCombat);
+DECLARE_CYCLE_STAT(TEXT("Set Thruster Parameters"), STAT_SetThrusterParameters, STATGROUP_AerialCombat);
+
 // Sets default values
 ACombatVehicle::ACombatVehicle() : NetClientPredStats()
 {
  	// Set this pawn to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
-	// Setup Health
-	CurrentHealth = MaxHealth;
-
 	// Initialize Fire Rate
 	FireRate = 0.25f;
 	bIsShooting = false;
@@ -72,13 +82,8 @@ void ACombatVehicle::BeginPlay()
 	check(JetFlameLeftMeshComp != nullptr);
 
 	JetFlameCenterScale = JetFlameCenterMeshComp->GetRelativeScale3D();
-	JetFlameCenterPosition = JetFlameCenterMeshComp->GetRelativeLocation();
-
 	JetFlameRightScale = JetFlameRightMeshComp->GetRelativeScale3D();
-	JetFlameRightPosition = JetFlameRightMeshComp->GetRelativeLocation();
-
 	JetFlameLeftScale = JetFlameLeftMeshComp->GetRelativeScale3D();
-	JetFlameLeftPosition = JetFlameLeftMeshComp->GetRelativeLocation();
 
 	// Setup Thrust Flame Particles
 	ThrusterFlameCenterNS = Cast<UNiagaraComponent>(GetDefaultSubobjectByName("NS_ThrustFlame_Center"));
@@ -89,6 +94,8 @@ void ACombatVehicle::BeginPlay()
 	check(ThrusterFlameRightNS != nullptr);
 	check(ThrusterFlameLeftNS != nullptr);
 
+	CacheThrusterParameterOffsets();
+
 	BrakeFlameCenterNS = Cast<UNiagaraComponent>(GetDefaultSubobjectByName("NS_BrakeFlame_Center"));
 	BrakeFlameRightNS = Cast<UNiagaraComponent>(GetDefaultSubobjectByName("NS_BrakeFlame_Right"));
 	BrakeFlameLeftNS = Cast<UNiagaraComponent>(GetDefaultSubobjectByName("NS_BrakeFlame_Left"));
@@ -114,15 +121,48 @@ void ACombatVehicle::BeginPlay()
 	// Hovering
 	bShouldHover = false;
 
-	HoverTime = 0.0f;
+	// Movement is Driven by the Movement Model, MeshComp only Mirrors it
+	MeshComp->SetSimulatePhysics(false);
+	UpdateMovementParams();
+	MovementState.Location = GetActorLocation();
+	MovementState.Rotation = GetActorRotation();
 
 	// Override the Light Ridge Material Instance
 	int32 LightRidgeMatIndex = 3; // HARDCODED MATERIAL INDEX
-	LightRidgeMaterial = UMaterialInstanceDynamic::Create(MeshComp->GetMaterial(LightRidgeMatIndex), this);
+	UMaterialInterface* LightRidgeParentMaterial = MeshComp->GetMaterial(LightRidgeMatIndex);
+	LightRidgeMaterial = UMaterialInstanceDynamic::Create(LightRidgeParentMaterial, this);
 	if (LightRidgeMaterial)
 	{
 		MeshComp->SetMaterial(LightRidgeMatIndex, LightRidgeMaterial);
-		CurrLightRidgeColor = LightRidgeColorStart;
+
+		// Only Materials that Expose the Cycle Parameters can Run the Cycle, the CPU Pushes the Color otherwise
+		float CycleParamValue = 0.0f;
+		const bool bMaterialCanCycle = bLightRidgeCycleInMaterial
+			&& LightRidgeParentMaterial->GetScalarParameterValue(FHashedMaterialParameterInfo(TEXT("CycleBlend")), CycleParamValue)
+			&& LightRidgeParentMaterial->GetScalarParameterValue(FHashedMaterialParameterInfo(TEXT("CycleStartTime")), CycleParamValue);
+
+		// Every Vehicle Shares the Material, Warn once for it
+		static TSet<FObjectKey> WarnedLightRidgeMaterials;
+		bool bAlreadyWarned = false;
+		if (bLightRidgeCycleInMaterial && !bMaterialCanCycle)
+		{
+			WarnedLightRidgeMaterials.Add(FObjectKey(LightRidgeParentMaterial), &bAlreadyWarned);
+			if (!bAlreadyWarned)
+			{
+				UE_LOG(LogAerialCombat, Warning, TEXT("Light ridge material %s has no CycleBlend/CycleStartTime parameters, cycling its color on the CPU."),
+					*LightRidgeParentMaterial->GetName());
+			}
+		}
+
+		// Parameters are Set by Index from then on (No Name Lookups)
+		LightRidgeMaterial->InitializeVectorParameterAndGetIndex("LightColor", LightRidgeColorStart, LightRidgeColorIndex);
+		if (bMaterialCanCycle)
+		{
+			LightRidgeMaterial->SetVectorParameterValue("ColorStart", LightRidgeColorStart);
+			LightRidgeMaterial->SetVectorParameterValue("ColorEnd", LightRidgeColorEnd);
+			LightRidgeMaterial->InitializeScalarParameterAndGetIndex("CycleStartTime", 0.0f, LightRidgeCycleStartIndex);
+			LightRidgeMaterial->InitializeScalarParameterAndGetIndex("CycleBlend", 0.0f, LightRidgeCycleBlendIndex);
+		}
 	}
 
 	// Initialize Camera Post-Process Materials
@@ -130,7 +170,7 @@ void ACombatVehicle::BeginPlay()
 	SpeedLinesMaterial = UMaterialInstanceDynamic::Create(SpeedLinesMaterialInterface, this);
 	if (SpeedLinesMaterial)
 	{
-		SpeedLinesMaterial->SetScalarParameterValue("Alpha", 0.0f);
+		SpeedLinesMaterial->InitializeScalarParameterAndGetIndex("Alpha", 0.0f, SpeedLinesAlphaIndex);
 
 		// Add to Camera Post-Processing
 		VehicleCameraComp->PostProcessSettings.AddBlendable(SpeedLinesMaterial, 1.0f);
@@ -139,7 +179,7 @@ void ACombatVehicle::BeginPlay()
 	HitEffectMaterial = UMaterialInstanceDynamic::Create(HitEffectMaterialInterface, this);
 	if (HitEffectMaterial)
 	{
-		HitEffectMaterial->SetScalarParameterValue("Alpha", 0.0f);
+		HitEffectMaterial->InitializeScalarParameterAndGetIndex("Alpha", 0.0f, HitEffectAlphaIndex);
 
 		// Add to Camera Post-Processing
 		VehicleCameraComp->PostProcessSettings.AddBlendable(HitEffectMaterial, 1.0f);
@@ -149,17 +189,51 @@ void ACombatVehicle::BeginPlay()
 	DecalMaterial = Cast<UMaterialInterface>(StaticLoadObject(UMaterial::StaticClass(), nullptr, TEXT("/Game/Models/Decals/M_ProjectileDecal.M_ProjectileDecal")));
 
 	// Initialize Health for UI
-	UI_OnHealthUpdate(CurrentHealth);
+	UI_OnHealthUpdate(GetCurrentHealth());
 	bDeathQueued = false;
 
 	// Network Check
 	bReplicates = true;
 	bIsClient = (GetNetMode() == ENetMode::NM_Client);
-	
-	// Disable Gravity for Simulated Proxies
-	if (GetLocalRole() == ROLE_SimulatedProxy)
+
+	// Visuals are Batched with every other Vehicle's
+	if (GetNetMode() != NM_DedicatedServer)
 	{
-		MeshComp->SetEnableGravity(false);
+		GetWorld()->GetSubsystem<UVehicleVisualsSubsystem>()->RegisterVehicle(this);
+	}
+}
+
+void ACombatVehicle::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	UnbindHealthAttribute();
+
+	if (UVehicleVisualsSubsystem* VisualsSubsystem = GetWorld()->GetSubsystem<UVehicleVisualsSubsystem>())
+	{
+		VisualsSubsystem->UnregisterVehicle(this);
+	}
+	if (UImpactDecalSubsystem* DecalSubsystem = GetWorld()->GetSubsystem<UImpactDecalSubsystem>())
+	{
+		DecalSubsystem->ReleaseDecals(this);
+	}
+
+	// Report Move Batching for this Connection
+	if (HasAuthority() && NetMoveBatchStats.NumBatches > 0)
+	{
+		UE_LOG(LogAerialCombat, Log, TEXT("%s: Received %d moves in %d RPCs (%d RPCs saved, %d redundant, %d missed, %d throttled), %.1f payload bytes per RPC."),
+			*GetName(), NetMoveBatchStats.NumMovesApplied, NetMoveBatchStats.NumBatches, NetMoveBatchStats.GetNumRPCsSaved(),
+			NetMoveBatchStats.NumRedundantMoves, NetMoveBatchStats.NumMovesMissed, NetMoveBatchStats.NumMovesThrottled,
+			NetMoveBatchStats.PayloadBits / 8.0 / NetMoveBatchStats.NumBatches);
+	}
+
+	// Report Interpolation of this Remote Vehicle
+	const FVehicleSnapshotStats& SnapshotStats = SnapshotBuffer.GetStats();
+	if (GetLocalRole() == ROLE_SimulatedProxy && SnapshotStats.NumSnapshots > 0)
+	{
+		UE_LOG(LogAerialCombat, Log, TEXT("%s: Buffered %d snapshots (%d out of order, %d clock resyncs), %d underruns, %.2fs extrapolated (max %.3fs), %d frames frozen."),
+			*GetName(), SnapshotStats.NumSnapshots, SnapshotStats.NumOutOfOrder, SnapshotStats.NumClockResyncs, SnapshotStats.NumUnderruns,
+			SnapshotStats.TotalExtrapolationTime, SnapshotStats.MaxExtrapolationTime, SnapshotStats.NumFrozenFrames);
 	}
 }
 
@@ -168,66 +242,93 @@ void ACombatVehicle::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	// Reconcile for Autonomous and Simulated Proxies
-	if (!HasAuthority())
+	// Simulated Proxies Render the Buffered Server Updates with a Delay
+	// (Autonomous Proxy Reconciles by Replaying its Moves in OnRep_ServerStats)
+	if (GetLocalRole() == ROLE_SimulatedProxy)
 	{
-		FVector ReconciledLocation = FMath::VInterpTo(GetActorLocation(), ServerStats.Location, DeltaTime, 4.0f);
-		FRotator ReconciledRotation = FMath::RInterpTo(GetActorRotation(), ServerStats.Rotation, DeltaTime, 4.0f);
-
-		// Simulated Proxies will Always Reconcile
-		if (GetLocalRole() == ROLE_SimulatedProxy)
+		FVehicleSnapshot Snapshot;
+		const double RenderTime = SnapshotBuffer.GetServerTime(GetWorld()->GetTimeSeconds()) - GetInterpolationDelay();
+		if (SnapshotBuffer.Sample(RenderTime, MaxExtrapolationTime, DeltaTime, Snapshot))
 		{
-			SetActorLocationAndRotation(ReconciledLocation, ReconciledRotation);
+			SetActorLocationAndRotation(Snapshot.Location, Snapshot.Rotation);
+			MeshComp->ComponentVelocity = Snapshot.Velocity;
 		}
+	}
 
-		// Autonomous Proxy will Reconcile with Server if needed
-		if (bShouldReconcileMovement)
+	// Perform Physics Locally
+	if (IsLocallyControlled())
+	{
+		UpdateBoostMode(DeltaTime);
+		UpdateTurretOrientation();
+
+		// Run as many Fixed Movement Steps as the Frame Time covers
+		MovementStepAccumulator += DeltaTime;
+		int32 NumSteps = 0;
+		while (MovementStepAccumulator >= MovementParams.FixedStepSeconds && NumSteps < MaxMovementStepsPerFrame)
 		{
-			FVector ReconciledVelocity = FMath::VInterpTo(GetVelocity(), ServerStats.Velocity, DeltaTime, 4.0f);
+			MovementStepAccumulator -= MovementParams.FixedStepSeconds;
+			++NumSteps;
 
-			SetActorLocationAndRotation(ReconciledLocation, ReconciledRotation);
-			if (IsLocallyControlled()) // Simulated Proxies don't need to worry about Velocity
+			// Apply Move
+			CurrTickClientMove.Sequence = NextMoveSequence++;
+			CurrTickClientMove.QuantizeBoostRotation();
+			if (HasAuthority())
 			{
-				MeshComp->SetPhysicsLinearVelocity(ReconciledVelocity);
+				// Listen Server applies its own Moves right away
+				ServerApplyMove(CurrTickClientMove);
+				continue;
 			}
 
-			// Check if Reconciled (Using Location only)
-			FVector LocError = ReconciledLocation - ServerStats.Location;
-			bShouldReconcileMovement = LocError.SizeSquared() > MaxNetPredictionError * MaxNetPredictionError;
+			UpdateMovement(CurrTickClientMove);
+
+			// Enqueue the Resultant Move of this Step (Sent to the Server in the Next Batch)
+			NetClientPredStats.AddMove(CurrTickClientMove);
 		}
-	}
 
-	// Perform Physics Locally
-	if (IsLocallyControlled())
-	{
-		UpdateBoostMode(DeltaTime);
-		UpdateLightRidgeColor(DeltaTime);
-		UpdateJetFlameVisuals(DeltaTime);
-		SetThrustFlameVisuals();
-		SetTurningFlameVisuals();
-		SetSpeedTrailVisuals();
-		UpdateHitEffect(DeltaTime);
+		// Ask Server to Authorize Moves
+		NetMoveSendAccumulator += DeltaTime;
+		const float NetMoveSendInterval = 1.0f / FMath::Max(NetMoveSendRate, 1.0f);
+		if (!HasAuthority() && NetMoveSendAccumulator >= NetMoveSendInterval)
+		{
+			NetMoveSendAccumulator = FMath::Fmod(NetMoveSendAccumulator, NetMoveSendInterval);
+			SendMoveBatch();
+		}
 
-		UpdateTurretOrientation();
+		// Drop the Time we couldn't catch up on
+		MovementStepAccumulator = FMath::Fmod(MovementStepAccumulator, MovementParams.FixedStepSeconds);
 
-		// Apply Move
-		CurrTickClientMove.Timestamp = GetWorld()->GetTimeSeconds();
-		if (!HasAuthority())
+		// Prepare for the Next Step (Held Inputs are Re-applied every Frame)
+		if (NumSteps > 0)
 		{
-			UpdateMovement(CurrTickClientMove);
+			CurrTickClientMove = FNetClientMove();
 		}
-		
-		// Enqueue the Resultant Move of this Tick
-		NetClientPredStats.AddMove(CurrTickClientMove);
-		
-		// Ask Server to Authorize Move
-		RPC_Server_UpdateMovement(CurrTickClientMove);
 
-		// Prepare for the Next Tick
-		CurrTickClientMove = FNetClientMove();
+		// Update Visuals on Remote Clients (When they Change, or Unchanged once per Refresh Interval as the RPC is Unreliable)
+		NetVisualsSendAccumulator += DeltaTime;
+		NetVisualsRefreshTimer += DeltaTime;
+		if (NetVisualsSendAccumulator >= NetMoveSendInterval)
+		{
+			NetVisualsSendAccumulator = FMath::Fmod(NetVisualsSendAccumulator, NetMoveSendInterval);
 
-		// Update Visuals on Remote Clients
-		RPC_Server_UpdateVisuals(CurrTickClientVisuals);
+			FNetClientVisuals NewVisuals = GatherClientVisuals();
+			if (NewVisuals != LastSentClientVisuals || NetVisualsRefreshTimer >= NetVisualsRefreshInterval)
+			{
+				RPC_Server_UpdateVisuals(NewVisuals);
+				LastSentClientVisuals = NewVisuals;
+				NetVisualsRefreshTimer = 0.0f;
+			}
+		}
+	}
+	if (HasAuthority())
+	{
+		PublishServerStats(DeltaTime);
+
+		// Remember this Frame's Pose for Lag Compensation
+		FVehiclePose Pose;
+		Pose.Time = GetWorld()->GetTimeSeconds();
+		Pose.Location = GetActorLocation();
+		Pose.Rotation = GetActorQuat();
+		PoseHistory.AddPose(Pose);
 	}
 }
 
@@ -266,6 +367,8 @@ void ACombatVehicle::SetupPlayerInputComponent(UInputComponent* PlayerInputCompo
 		
 		// Shooting
 		EnhancedInputComponent->BindAction(FireInputAction, ETriggerEvent::Triggered, this, &ACombatVehicle::StartShooting);
+		EnhancedInputComponent->BindAction(FireInputAction, ETriggerEvent::Completed, this, &ACombatVehicle::ReleaseShooting);
+		EnhancedInputComponent->BindAction(FireInputAction, ETriggerEvent::Canceled, this, &ACombatVehicle::ReleaseShooting);
 
 		// Boost Mode
 		EnhancedInputComponent->BindAction(BoostInputAction, ETriggerEvent::Triggered, this, &ACombatVehicle::ActivateBoost);
@@ -283,6 +386,12 @@ void ACombatVehicle::PossessedBy(AController* NewController)
 	{
 		AbilitySystemComp = Cast<UCVAbilitySystemComponent>(PS->AbilitySystemComponent);
 		AbilitySystemComp->InitAbilityActorInfo(PS, this);
+
+		// A New Vehicle Starts with Full Health, the Attribute Set Outlives the Last One
+		AbilitySystemComp->SetNumericAttributeBase(UCVAttributeSet::GetMaxHealthAttribute(), MaxHealth);
+		AbilitySystemComp->SetNumericAttributeBase(UCVAttributeSet::GetHealthAttribute(), MaxHealth);
+
+		BindHealthAttribute();
 	}
 }
 
@@ -298,9 +407,43 @@ void ACombatVehicle::OnRep_PlayerState()
 
 		// Init ASC Actor Info for clients. Server will init its ASC when it possesses a new Actor.
 		AbilitySystemComp->InitAbilityActorInfo(PS, this);
+
+		BindHealthAttribute();
 	}
 }
 
+void ACombatVehicle::BindHealthAttribute()
+{
+	UnbindHealthAttribute();
+
+	HealthAttributes = AbilitySystemComp ? AbilitySystemComp->GetSet<UCVAttributeSet>() : nullptr;
+	if (!HealthAttributes)
+		return;
+
+	HealthChangedHandle = AbilitySystemComp->GetGameplayAttributeValueChangeDelegate(UCVAttributeSet::GetHealthAttribute())
+		.AddUObject(this, &ACombatVehicle::OnHealthAttributeChanged);
+
+	OnHealthUpdate();
+}
+
+void ACombatVehicle::UnbindHealthAttribute()
+{
+	if (AbilitySystemComp && HealthChangedHandle.IsValid())
+	{
+		AbilitySystemComp->GetGameplayAttributeValueChangeDelegate(UCVAttributeSet::GetHealthAttribute()).Remove(HealthChangedHandle);
+	}
+	HealthChangedHandle.Reset();
+}
+
+void ACombatVehicle::OnHealthAttributeChanged(const FOnAttributeChangeData& ChangeData)
+{
+	// The Player State may have Moved on to a New Vehicle
+	if (AbilitySystemComp && AbilitySystemComp->GetAvatarActor_Direct() != this)
+		return;
+
+	OnHealthUpdate();
+}
+
 UCVAbilitySystemComponent* ACombatVehicle::GetAbilitySystemComponent() const
 {
 	return AbilitySystemComp;
@@ -329,8 +472,6 @@ void ACombatVehicle::StopAscending(const FInputActionValue& Value)
 {
 	bShouldHover = true;
 	bAscending = false;
-	MaxVelAchieved = GetVelocity().Z;
-	HoverTime = 0.0f;
 }
 
 void ACombatVehicle::Descend(const FInputActionValue& Value)
@@ -345,8 +486,6 @@ void ACombatVehicle::StopDescending(const FInputActionValue& Value)
 {
 	bShouldHover = true;
 	bDescending = false;
-	MaxVelAchieved = GetVelocity().Z;
-	HoverTime = 0.0f;
 }
 
 void ACombatVehicle::MoveForward(const FInputActionValue& Value)
@@ -411,172 +550,263 @@ void ACombatVehicle::ActivateBoost(const FInputActionValue& Value)
 	}
 }
 
-void ACombatVehicle::UpdateMovement(FNetClientMove& Move)
+void ACombatVehicle::UpdateMovement(const FNetClientMove& Move)
 {
-	//// Global Control Parameters for Movement
-	//static float MaxVerticalVelocityAchieved = 0.0f;
+	// Movement Flags (Used by the Visuals)
+	bShouldHover = !(FMath::Abs(Move.InputVertical) > 0.0f);
+	bBoostActive = Move.InputBoost > 0.0f;
+	bMoving = FMath::Abs(Move.InputForward) > 0.0f;
+	bTurning = FMath::Abs(Move.InputSteering) > 0.0f;
 
-	// Read the Inputs and generate the required Forces/Velocities
-	FVector ApplyVelocity = FVector();
-	FVector ApplyForce = FVector();
-	FVector3d SetVelocityComp = FVector3d();
+	StepMovementState(MovementState, Move);
+	MirrorMovementState();
+}
 
-	// Ascending/Descending
-	bShouldHover = true;
-	if (FMath::Abs(Move.InputVertical) > 0.0f)
+void ACombatVehicle::ReplayUnacknowledgedMoves()
+{
+	// Rewind to the Authoritative State
+	FVehicleMovementState State = ServerStats.GetMovementState();
+
+	// Resimulate every Move the Server hasn't Processed yet
+	const int NumMoves = NetClientPredStats.GetNumOfMoves();
+	for (int i = 0; i < NumMoves; ++i)
 	{
-		float MaxVerticalVelocity = Move.InputVertical > 0.0f ? MaxAscentVelocity : MaxDescentVelocity;
-		float VerticalAcc = Move.InputVertical > 0.0f ? AscentAcceleration : DescentAcceleration;
+		StepMovementState(State, NetClientPredStats.GetMove(i));
+	}
 
-		if (GetVelocity().Z > MaxVerticalVelocity)
-		{
-			ApplyVelocity.Z = MaxVerticalVelocity;
-			SetVelocityComp.Z = 1;
-		}
-		else
-		{
-			ApplyForce += FVector(0.0f, 0.0f, GameGravity + VerticalAcc);
-		}
+	++NetReconcileStats.NumReplays;
+	NetReconcileStats.NumReplayedMoves += NumMoves;
 
-		MaxVelAchieved = GetVelocity().Z;
-		HoverTime = 0.0f;
-		bShouldHover = false;
-	}
-	
-	// Forward Movement (with Boost)
-	bBoostActive = Move.InputBoost > 0.0f;
-	bMoving = false;
+	// Only Correct if the Prediction has Drifted too far
+	const float Error = FVector::Dist(MovementState.Location, State.Location);
+	if (Error <= MaxNetPredictionError)
+		return;
 
-	if (Move.InputForward > 0.0f)
-	{
-		float UseMaxVel = bBoostActive ? BoostModeMaxVelocity : MaxMovementVelocity;
-		float UseAcc = bBoostActive ? BoostModeAcceleration : MovementAcceleration;
-		if (GetVelocity().SquaredLength() > UseMaxVel * UseMaxVel && GetVelocity().Dot(GetActorForwardVector()) > 0.0f)
-		{
-			FVector Vel = UseMaxVel * GetActorForwardVector();
-			ApplyVelocity.X = Vel.X;
-			ApplyVelocity.Y = Vel.Y;
-			SetVelocityComp.X = 1;
-			SetVelocityComp.Y = 1;
-		}
-		else
-		{
-			// Apply Acceleration
-			FVector Acc = UseAcc * GetActorForwardVector();
-			ApplyForce += Acc;
-		}
+	// Snap to the Replayed State (Converges in a Single Frame)
+	MovementState = State;
+	MirrorMovementState();
 
-		bMoving = true;
-	}
-	else if (Move.InputForward < 0.0f) // Backward Movement
-	{
-		FVector Vel(GetVelocity());
-		Vel.Z = 0.0f;
+	++NetReconcileStats.NumCorrections;
+	NetReconcileStats.LastCorrectionError = Error;
+	NetReconcileStats.MaxCorrectionError = FMath::Max(NetReconcileStats.MaxCorrectionError, Error);
+	NetReconcileStats.TotalCorrectionError += Error;
 
-		if (Vel.SquaredLength() > MaxMovementVelocity * MaxMovementVelocity && Vel.Dot(-GetActorForwardVector()) > 0.0f)
-		{
-			Vel = -MaxMovementVelocity * GetActorForwardVector();
-			ApplyVelocity.X = Vel.X;
-			ApplyVelocity.Y = Vel.Y;
-			SetVelocityComp.X = 1;
-			SetVelocityComp.Y = 1;
-		}
-		else
-		{
-			// Apply Acceleration
-			FVector Acc = -MovementAcceleration * GetActorForwardVector();
-			ApplyForce += Acc;
-		}
+	UE_LOG(LogAerialCombat, Verbose, TEXT("%s: Corrected %.1f cm after replaying %d moves (%d corrections in %d replays, max %.1f cm)."),
+		*GetName(), Error, NumMoves, NetReconcileStats.NumCorrections, NetReconcileStats.NumReplays, NetReconcileStats.MaxCorrectionError);
+}
 
-		bMoving = true;
-	}
-	
-	// Steering
-	FVector Torque = FVector();
-	FVector AngVelocity = FVector();
-	bool bSetAngVelocity = false;
+void ACombatVehicle::SendMoveBatch()
+{
+	const int NumMoves = NetClientPredStats.GetNumOfMoves();
+	if (NumMoves == 0)
+		return;
 
-	bTurning = false;
+	// Resend the Newest Unacknowledged Moves, so the Server can Apply them in Order even after Lost Packets. If the Ack
+	// falls further behind than a Batch, the Oldest Moves are Given up on (the Server Skips them and the Replay
+	// Corrects), the Latest Input always Goes out.
+	const int MaxToSend = FMath::Min(FMath::Max(NetMaxMovesPerBatch, 1), static_cast<int>(FNetClientMoveBatch::MaxMovesPerBatch));
 
-	if (FMath::Abs(Move.InputSteering) > 0.0f)
-	{
-		float UseMaxTurningSpeed = Move.InputSteering > 0.0f ? MaxTurningSpeed : -MaxTurningSpeed;
-		float UseTurningTorque = Move.InputSteering > 0.0f ? TurningTorque : -TurningTorque;
+	FNetClientMoveBatch MoveBatch;
+	NetClientPredStats.GetNewestMoves(MaxToSend, MoveBatch.Moves);
 
-		if (MeshComp->GetPhysicsAngularVelocityInDegrees().SquaredLength() > MaxTurningSpeed * MaxTurningSpeed)
-		{
-			AngVelocity = FVector(0.0f, 0.0f, UseMaxTurningSpeed);
-			bSetAngVelocity = true;
-		}
-		else
-		{
-			Torque += FVector(0.0f, 0.0f, UseTurningTorque);
-		}
+	RPC_Server_UpdateMoves(MoveBatch);
+}
+
+bool ACombatVehicle::ServerApplyMove(const FNetClientMove& Move)
+{
+	// Ignore Moves already Applied (Acknowledged Sequence must only move Forward)
+	const int32 SequenceDelta = static_cast<int32>(Move.Sequence - ServerAckSequence);
+	if (SequenceDelta <= 0)
+		return false;
+
+	// Moves Lost in every Packet that carried them
+	NetMoveBatchStats.NumMovesMissed += SequenceDelta - 1;
+
+	// Apply the Move on the Remote Actor
+	UpdateMovement(Move);
+	ServerAckSequence = Move.Sequence;
 
-		bTurning = true;
+	// A Settled Vehicle only Publishes to Move the Ack along
+	if (!bServerStatsPending)
+	{
+		bServerStatsPending = HasUnpublishedMovement() || HasUnpublishedAck();
 	}
-	
-	// Update Vehicle Rotation for Boost Mode
-	FRotator Rotation = Move.BoostRotation;
-	
-	// Update Hovering Physics
-	float VelZ = ApplyVelocity.Z;
-	ComputeHoverPhysics(GetWorld()->GetDeltaSeconds(), VelZ, ApplyForce);
-	if (bShouldHover)
+
+	return true;
+}
+
+void ACombatVehicle::UpdateServerStats()
+{
+	SCOPE_CYCLE_COUNTER(STAT_PublishServerStats);
+
+	// Update Server Stats (Replicated Property)
+	ServerStats.AckSequence = ServerAckSequence;
+	ServerStats.SetMovementState(MovementState);
+
+	// Round to the Replicated Precision (HasUnpublishedMovement Compares against it)
+	ServerStats.Quantize();
+
+	if (IsLocallyControlled())
 	{
-		ApplyVelocity.Z = VelZ;
-		SetVelocityComp.Z = 1;
+		return;
 	}
-	
-	// Update Deceleration when not moving
-	ComputeDeceleration(GetWorld()->GetDeltaSeconds(), ApplyForce, Torque);
 
+	// Continue from the Rounded State, so the Owning Client Replays from exactly the Same State
+	MovementState = ServerStats.GetMovementState();
+	MirrorMovementState();
+}
 
-	// Apply the Move on the Actor
-	FVector Vel;
-	Vel.X = (SetVelocityComp.X > 0) ? ApplyVelocity.X : MeshComp->GetPhysicsLinearVelocity().X;
-	Vel.Y = (SetVelocityComp.Y > 0) ? ApplyVelocity.Y : MeshComp->GetPhysicsLinearVelocity().Y;
-	Vel.Z = (SetVelocityComp.Z > 0) ? ApplyVelocity.Z : MeshComp->GetPhysicsLinearVelocity().Z;
-	MeshComp->SetPhysicsLinearVelocity(Vel);
-	MeshComp->AddForce(ApplyForce, NAME_None, true);
+bool ACombatVehicle::HasUnpublishedMovement() const
+{
+	return ServerStats.DiffersFrom(MovementState);
+}
 
-	SetActorRotation(Rotation);
+bool ACombatVehicle::HasUnpublishedAck() const
+{
+	return static_cast<int32>(ServerAckSequence - ServerStats.AckSequence) >= FMath::Max(ServerAckPublishGap, 1);
+}
+
+void ACombatVehicle::PublishServerStats(float DeltaTime)
+{
+	// Publishing Faster than the Actor Replicates only Overwrites States no one Receives
+	ServerStatsPublishAccumulator += DeltaTime;
+	const float PublishInterval = 1.0f / FMath::Max(FMath::Min(ServerStatsPublishRate, GetNetUpdateFrequency()), 1.0f);
+	if (ServerStatsPublishAccumulator < PublishInterval)
+		return;
 
-	if (bSetAngVelocity)
-		MeshComp->SetPhysicsAngularVelocityInDegrees(AngVelocity);
-	MeshComp->AddTorqueInDegrees(Torque, NAME_None, true);
+	ServerStatsPublishAccumulator = FMath::Fmod(ServerStatsPublishAccumulator, PublishInterval);
+
+	// Nothing New to Send
+	if (!bServerStatsPending)
+		return;
+
+	UpdateServerStats();
+	MARK_PROPERTY_DIRTY_FROM_NAME(ACombatVehicle, ServerStats, this);
+	bServerStatsPending = false;
+
+	UpdateNetUpdateFrequency();
 }
 
-void ACombatVehicle::ComputeHoverPhysics(float DeltaTime, float& VelZ, FVector& Force)
+void ACombatVehicle::UpdateNetUpdateFrequency()
 {
-	if (bShouldHover)
+	float NewFrequency = BoostNetUpdateFrequency;
+	if (!bBoostActive)
 	{
-		HoverTime += DeltaTime;
+		const float SpeedAlpha = FMath::Clamp(MovementState.Velocity.Size() / FMath::Max(MaxMovementVelocity, 1.0f), 0.0f, 1.0f);
+		NewFrequency = FMath::Lerp(MinNetUpdateFrequency, MaxNetUpdateFrequency, SpeedAlpha);
+	}
 
-		// Update Output Parameters
-		//
-		// Damped Cosine Wave
-		VelZ = WobbleAmplitude * FMath::Exp(-WobbleDecayConst * HoverTime) * FMath::Cos(WobbleFrequency * HoverTime) * MaxVelAchieved;
-		// Pushback against Gravity
-		Force += FVector(0.0f, 0.0f, GameGravity);
+	// Avoid Churning the Replication Schedule over Tiny Changes
+	if (FMath::Abs(NewFrequency - GetNetUpdateFrequency()) >= 1.0f)
+	{
+		SetNetUpdateFrequency(NewFrequency);
+
+		// Replication Graph Schedules by its own Period
+		if (UACReplicationGraph* ReplicationGraph = GetNetDriver() ? Cast<UACReplicationGraph>(GetNetDriver()->GetReplicationDriver()) : nullptr)
+		{
+			ReplicationGraph->SetActorReplicationFrequency(this, NewFrequency);
+		}
 	}
 }
 
-void ACombatVehicle::ComputeDeceleration(float DeltaTime, FVector& Force, FVector& Torque)
+bool ACombatVehicle::GetRewoundTransform(double Time, FTransform& OutTransform) const
 {
-	if (!bMoving)
-	{
-		FVector Acc = -GetVelocity() * DecelerateFactor;
-		Force += FVector(Acc.X, Acc.Y, 0.0f);
-	}
+	FVehiclePose Pose;
+	if (!PoseHistory.GetPoseAtTime(Time, Pose))
+		return false;
+
+	OutTransform = FTransform(Pose.Rotation, Pose.Location, GetActorScale3D());
+	return true;
+}
+
+bool ACombatVehicle::WasLockedInAt(double Time) const
+{
+	// Shots Fired before Unlocking may Arrive after it (Batched, or on another Channel)
+	return bServerLockedIn || (Time >= ServerLockInTime && Time <= ServerUnlockTime);
+}
+
+FVector ACombatVehicle::GetTurretPivotOffset(const FTransform& VehicleTransform) const
+{
+	if (!TurretMeshComp)
+		return FVector::ZeroVector;
 
-	if (!bTurning)
+	// The Turret only Rotates about its Pivot, which stays Fixed on the Hull
+	const FVector LocalPivot = GetActorTransform().InverseTransformPosition(TurretMeshComp->GetComponentLocation());
+	return VehicleTransform.TransformVector(LocalPivot);
+}
+
+void ACombatVehicle::UpdateMovementParams()
+{
+	MovementParams.AscentAcceleration = AscentAcceleration;
+	MovementParams.MaxAscentVelocity = MaxAscentVelocity;
+	MovementParams.DescentAcceleration = DescentAcceleration;
+	MovementParams.MaxDescentVelocity = MaxDescentVelocity;
+
+	MovementParams.MovementAcceleration = MovementAcceleration;
+	MovementParams.MaxMovementVelocity = MaxMovementVelocity;
+	MovementParams.BoostModeAcceleration = BoostModeAcceleration;
+	MovementParams.BoostModeMaxVelocity = BoostModeMaxVelocity;
+
+	MovementParams.DecelerateFactor = DecelerateFactor;
+	MovementParams.TurningTorque = TurningTorque;
+	MovementParams.MaxTurningSpeed = MaxTurningSpeed;
+
+	MovementParams.WobbleAmplitude = WobbleAmplitude;
+	MovementParams.WobbleDecayConst = WobbleDecayConst;
+	MovementParams.WobbleFrequency = WobbleFrequency;
+
+	MovementParams.FixedStepSeconds = 1.0f / FMath::Max(MovementStepRate, 1.0f);
+}
+
+FVehicleMoveInput ACombatVehicle::MakeMoveInput(const FNetClientMove& Move)
+{
+	FVehicleMoveInput Input;
+	Input.InputVertical = Move.InputVertical;
+	Input.InputForward = Move.InputForward;
+	Input.InputSteering = Move.InputSteering;
+	Input.InputBoost = Move.InputBoost;
+	Input.BoostPitch = Move.BoostRotation.Pitch;
+	Input.BoostRoll = Move.BoostRotation.Roll;
+	return Input;
+}
+
+void ACombatVehicle::StepMovementState(FVehicleMovementState& State, const FNetClientMove& Move) const
+{
+	const FVector From = State.Location;
+	State = FVehicleMovementModel::Step(MovementParams, State, MakeMoveInput(Move));
+
+	// Keep the Vehicle Blocked by the City
+	// Only Static Geometry is Swept: it is in the Same Place on Client and Server, while other Vehicles (and their
+	// Interpolated Copies) are not, and would make a Replay diverge from what the Server Simulated
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(CombatVehicleMove), false, this);
+	const FCollisionObjectQueryParams ObjectParams(ECC_WorldStatic);
+
+	FHitResult Hit;
+	if (GetWorld()->SweepSingleByObjectType(Hit, From, State.Location, State.Rotation.Quaternion(), ObjectParams,
+		MeshComp->GetCollisionShape(), QueryParams))
 	{
-		FVector AngAcc = -MeshComp->GetPhysicsAngularVelocityInDegrees() * DecelerateFactor;
-		Torque += AngAcc;
+		if (Hit.bStartPenetrating)
+		{
+			// Push out of whatever we are Stuck in
+			State.Location += Hit.Normal * (Hit.PenetrationDepth + 0.125f);
+		}
+		else
+		{
+			// Stop at the Surface and Slide along it
+			State.Location = Hit.Location + Hit.Normal * 0.125f;
+			State.Velocity = FVector::VectorPlaneProject(State.Velocity, Hit.Normal);
+		}
 	}
 }
 
+void ACombatVehicle::MirrorMovementState()
+{
+	SetActorLocationAndRotation(MovementState.Location, MovementState.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+
+	// Movement is Kinematic, so expose the Model's Velocity through GetVelocity()
+	MeshComp->ComponentVelocity = MovementState.Velocity;
+}
+
 void ACombatVehicle::UpdateBoostMode(float DeltaTime)
 {
 	bool bReturnZeroPitch = true;
@@ -620,14 +850,19 @@ void ACombatVehicle::UpdateBoostMode(float DeltaTime)
 		// Apply Post Process Material
 		SpeedLinesFadeTimer += DeltaTime * SpeedLinesFadeFactor;
 		SpeedLinesFadeTimer = (SpeedLinesFadeTimer > 1.0f) ? 1.0f : SpeedLinesFadeTimer;
-		SpeedLinesMaterial->SetScalarParameterValue("Alpha", SpeedLinesFadeTimer);
 	}
 	else
 	{
 		// Stop Post Process Material
 		SpeedLinesFadeTimer -= DeltaTime * SpeedLinesFadeFactor;
 		SpeedLinesFadeTimer = (SpeedLinesFadeTimer < 0.0f) ? 0.0f : SpeedLinesFadeTimer;
-		SpeedLinesMaterial->SetScalarParameterValue("Alpha", SpeedLinesFadeTimer);
+	}
+
+	// Only while Fading
+	if (SpeedLinesFadeTimer != SpeedLinesPushedAlpha && SpeedLinesMaterial)
+	{
+		SpeedLinesMaterial->SetScalarParameterByIndex(SpeedLinesAlphaIndex, SpeedLinesFadeTimer);
+		SpeedLinesPushedAlpha = SpeedLinesFadeTimer;
 	}
 
 	FRotator Rotation = GetActorRotation();
@@ -649,82 +884,8 @@ void ACombatVehicle::UpdateBoostMode(float DeltaTime)
 	}
 	SetActorRotation(Rotation);
 
-	// Replicate Boost Mode Movement and Visuals
+	// Replicate Boost Mode Movement
 	CurrTickClientMove.BoostRotation = Rotation;
-	CurrTickClientVisuals.bBoostModeActive = bBoostActive;
-}
-
-void ACombatVehicle::UpdateLightRidgeColor(float DeltaTime)
-{
-	// Lerp between Light Ridge Colors
-	LightRidgeLerpTimer += DeltaTime;
-
-	float LerpFactor = FMath::Abs(FMath::Sin(LightRidgeLerpTimer));
-
-	if (!bIsLockedIn)
-	{
-		// Fade back to Starting Color if recently Locked In
-		if (LightRidgeLockInTimer > 0.0f)
-		{
-			CurrLightRidgeColor = FMath::Lerp(LightRidgeColorStart, LightRidgeLockInColor, LightRidgeLockInTimer); // Lerp Backwards
-			LightRidgeLerpTimer = 0.0f;
-			LightRidgeLockInTimer -= DeltaTime * LightRidgeLockInFadeFactor;
-		}
-		else
-		{
-			// Proceed with Normal Color Cycle
-			CurrLightRidgeColor = FMath::Lerp(LightRidgeColorStart, LightRidgeColorEnd, LerpFactor);
-			ActiveLightRidgeColor = CurrLightRidgeColor;
-			LightRidgeLockInTimer = 0.0f;
-		}
-	}
-	else
-	{
-		// Fade to the Specified Lock In Color
-		LightRidgeLockInTimer = (LightRidgeLockInTimer < 1.0f) ? LightRidgeLockInTimer + DeltaTime * LightRidgeLockInFadeFactor : 1.0f;
-		CurrLightRidgeColor = FMath::Lerp(ActiveLightRidgeColor, LightRidgeLockInColor, LightRidgeLockInTimer);
-	}
-	
-	LightRidgeMaterial->SetVectorParameterValue("LightColor", CurrLightRidgeColor);
-
-	// Sync on all Instances
-	CurrTickClientVisuals.CurrLightRidgeColor = CurrLightRidgeColor;
-}
-
-void ACombatVehicle::UpdateJetFlameVisuals(float DeltaTime)
-{
-	float VelZ = GetVelocity().Z;
-
-	float ScaleMultiplier = 1.0f;
-	if (VelZ > 0.0f)
-	{
-		ScaleMultiplier += (VelZ / MaxAscentVelocity);
-	}
-	else
-	{
-		ScaleMultiplier -= (VelZ / MaxDescentVelocity);
-	}
-
-	FVector NewScale = JetFlameCenterScale;
-	NewScale.Z *= ScaleMultiplier;
-	JetFlameCenterMeshComp->SetRelativeScale3D(NewScale);
-	JetFlameCenterMeshComp->SetRelativeLocation(JetFlameCenterPosition);
-
-	CurrTickClientVisuals.JetFlameCenterScale = NewScale;
-
-	NewScale = JetFlameRightScale;
-	NewScale.Z *= ScaleMultiplier;
-	JetFlameRightMeshComp->SetRelativeScale3D(NewScale);
-	JetFlameRightMeshComp->SetRelativeLocation(JetFlameRightPosition);
-
-	CurrTickClientVisuals.JetFlameRightScale = NewScale;
-
-	NewScale = JetFlameLeftScale;
-	NewScale.Z *= ScaleMultiplier;
-	JetFlameLeftMeshComp->SetRelativeScale3D(NewScale);
-	JetFlameLeftMeshComp->SetRelativeLocation(JetFlameLeftPosition);
-
-	CurrTickClientVisuals.JetFlameLeftScale = NewScale;
 }
 
 void ACombatVehicle::SetThrustFlameVisuals()
@@ -754,36 +915,13 @@ void ACombatVehicle::SetThrustFlameVisuals()
 		{
 			if (!bSetThrustToBoostMode)
 			{
-				ThrusterFlameCenterNS->SetNiagaraVariableFloat(TEXT("User.SpawnRate"), NSThrustBoostSpawnRate);
-				ThrusterFlameRightNS->SetNiagaraVariableFloat(TEXT("User.SpawnRate"), NSThrustBoostSpawnRate);
-				ThrusterFlameLeftNS->SetNiagaraVariableFloat(TEXT("User.SpawnRate"), NSThrustBoostSpawnRate);
-
-				ThrusterFlameCenterNS->SetNiagaraVariableLinearColor(TEXT("User.ThrustColor"), NSThrustBoostColor);
-				ThrusterFlameRightNS->SetNiagaraVariableLinearColor(TEXT("User.ThrustColor"), NSThrustBoostColor);
-				ThrusterFlameLeftNS->SetNiagaraVariableLinearColor(TEXT("User.ThrustColor"), NSThrustBoostColor);
-				
-				ThrusterFlameCenterNS->SetNiagaraVariableFloat(TEXT("User.MaxLifeTime"), NSThrustBoostLifeTime);
-				ThrusterFlameRightNS->SetNiagaraVariableFloat(TEXT("User.MaxLifeTime"), NSThrustBoostLifeTime);
-				ThrusterFlameLeftNS->SetNiagaraVariableFloat(TEXT("User.MaxLifeTime"), NSThrustBoostLifeTime);
-
-
+				SetThrusterParameters(NSThrustBoostSpawnRate, NSThrustBoostColor, NSThrustBoostLifeTime);
 				bSetThrustToBoostMode = true;
 			}
 		}
 		else if (bSetThrustToBoostMode)
 		{
-			ThrusterFlameCenterNS->SetNiagaraVariableFloat(TEXT("User.SpawnRate"), NSThrustNormalSpawnRate);
-			ThrusterFlameRightNS->SetNiagaraVariableFloat(TEXT("User.SpawnRate"), NSThrustNormalSpawnRate);
-			ThrusterFlameLeftNS->SetNiagaraVariableFloat(TEXT("User.SpawnRate"), NSThrustNormalSpawnRate);
-
-			ThrusterFlameCenterNS->SetNiagaraVariableLinearColor(TEXT("User.ThrustColor"), NSThrustNormalColor);
-			ThrusterFlameRightNS->SetNiagaraVariableLinearColor(TEXT("User.ThrustColor"), NSThrustNormalColor);
-			ThrusterFlameLeftNS->SetNiagaraVariableLinearColor(TEXT("User.ThrustColor"), NSThrustNormalColor);
-
-			ThrusterFlameCenterNS->SetNiagaraVariableFloat(TEXT("User.MaxLifeTime"), NSThrustNormalLifeTime);
-			ThrusterFlameRightNS->SetNiagaraVariableFloat(TEXT("User.MaxLifeTime"), NSThrustNormalLifeTime);
-			ThrusterFlameLeftNS->SetNiagaraVariableFloat(TEXT("User.MaxLifeTime"), NSThrustNormalLifeTime);
-
+			SetThrusterParameters(NSThrustNormalSpawnRate, NSThrustNormalColor, NSThrustNormalLifeTime);
 			bSetThrustToBoostMode = false;
 		}
 	}
@@ -802,10 +940,48 @@ void ACombatVehicle::SetThrustFlameVisuals()
 			BrakeFlameLeftNS->Deactivate();
 		}
 	}
+}
 
-	// Send to Network
-	CurrTickClientVisuals.bActivateThrustOrBrakes = bMoving;
-	CurrTickClientVisuals.bMoveDirectionForward = bMoveDirectionForward;
+void ACombatVehicle::CacheThrusterParameterOffsets()
+{
+	const FNiagaraVariable SpawnRateParam(FNiagaraTypeDefinition::GetFloatDef(), TEXT("User.SpawnRate"));
+	const FNiagaraVariable ThrustColorParam(FNiagaraTypeDefinition::GetColorDef(), TEXT("User.ThrustColor"));
+	const FNiagaraVariable MaxLifeTimeParam(FNiagaraTypeDefinition::GetFloatDef(), TEXT("User.MaxLifeTime"));
+
+	// The Store's Layout is Fixed by the System Asset, so each Parameter is Looked up once
+	UNiagaraComponent* Thrusters[] = { ThrusterFlameCenterNS, ThrusterFlameRightNS, ThrusterFlameLeftNS };
+	for (int32 i = 0; i < UE_ARRAY_COUNT(Thrusters); ++i)
+	{
+		const FNiagaraParameterStore& Store = Thrusters[i]->GetOverrideParameters();
+		ThrusterParameterOffsets[i].SpawnRate = Store.IndexOf(SpawnRateParam);
+		ThrusterParameterOffsets[i].ThrustColor = Store.IndexOf(ThrustColorParam);
+		ThrusterParameterOffsets[i].MaxLifeTime = Store.IndexOf(MaxLifeTimeParam);
+	}
+}
+
+void ACombatVehicle::SetThrusterParameters(float SpawnRate, const FLinearColor& Color, float LifeTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SetThrusterParameters);
+
+	// Write Straight into the Cached Offsets, no Name Lookup per Write
+	UNiagaraComponent* Thrusters[] = { ThrusterFlameCenterNS, ThrusterFlameRightNS, ThrusterFlameLeftNS };
+	for (int32 i = 0; i < UE_ARRAY_COUNT(Thrusters); ++i)
+	{
+		FNiagaraUserRedirectionParameterStore& Store = Thrusters[i]->GetOverrideParameters();
+		const FThrusterParameterOffsets& Offsets = ThrusterParameterOffsets[i];
+		if (Offsets.SpawnRate != INDEX_NONE)
+		{
+			Store.SetParameterData(reinterpret_cast<const uint8*>(&SpawnRate), Offsets.SpawnRate, sizeof(float));
+		}
+		if (Offsets.ThrustColor != INDEX_NONE)
+		{
+			Store.SetParameterData(reinterpret_cast<const uint8*>(&Color), Offsets.ThrustColor, sizeof(FLinearColor));
+		}
+		if (Offsets.MaxLifeTime != INDEX_NONE)
+		{
+			Store.SetParameterData(reinterpret_cast<const uint8*>(&LifeTime), Offsets.MaxLifeTime, sizeof(float));
+		}
+	}
 }
 
 void ACombatVehicle::SetTurningFlameVisuals()
@@ -830,9 +1006,6 @@ void ACombatVehicle::SetTurningFlameVisuals()
 		if (TurnRightNS->IsActive())
 			TurnRightNS->Deactivate();
 	}
-
-	CurrTickClientVisuals.bActivateTurningFlames = bTurning;
-	CurrTickClientVisuals.bTurnDirectionRight = bTurnDirectionRight;
 }
 
 void ACombatVehicle::SetSpeedTrailVisuals()
@@ -871,16 +1044,6 @@ void ACombatVehicle::StopSpeedTrailVisuals()
 	}
 }
 
-void ACombatVehicle::UpdateHitEffect(float DeltaTime)
-{
-	if (HitEffectFadeTimer > 0.0f)
-	{
-		HitEffectFadeTimer -= DeltaTime * HitEffectFadeFactor;
-		HitEffectFadeTimer = (SpeedLinesFadeTimer < 0.0f) ? 0.0f : HitEffectFadeTimer;
-		HitEffectMaterial->SetScalarParameterValue("Alpha", HitEffectFadeTimer);
-	}
-}
-
 void ACombatVehicle::UpdateTurretOrientation()
 {
 	if (bIsLockedIn)
@@ -892,10 +1055,53 @@ void ACombatVehicle::UpdateTurretOrientation()
 		CorrectedTurretRotation.Roll = -CorrectedTurretRotation.Pitch;
 		CorrectedTurretRotation.Pitch = 0.0f;
 		TurretMeshComp->SetWorldRotation(CorrectedTurretRotation);
+	}
+}
+
+FNetClientVisuals ACombatVehicle::GatherClientVisuals() const
+{
+	FNetClientVisuals NewVisuals;
+	NewVisuals.SetFlag(FNetClientVisuals::ActivateThrustOrBrakes, bMoving);
+	NewVisuals.SetFlag(FNetClientVisuals::MoveDirectionForward, bMoveDirectionForward);
+	NewVisuals.SetFlag(FNetClientVisuals::ActivateTurningFlames, bTurning);
+	NewVisuals.SetFlag(FNetClientVisuals::TurnDirectionRight, bTurnDirectionRight);
+	NewVisuals.SetFlag(FNetClientVisuals::IsLockedIn, bIsLockedIn);
+	NewVisuals.SetFlag(FNetClientVisuals::BoostModeActive, bBoostActive);
 
-		CurrTickClientVisuals.TurretRotation = CorrectedTurretRotation;
+	if (bIsLockedIn)
+	{
+		NewVisuals.SetTurretRotation(TurretMeshComp->GetComponentRotation());
+	}
+
+	return NewVisuals;
+}
+
+void ACombatVehicle::ApplyVisualState()
+{
+	// Don't Run on Local Client, or on a Dedicated Server (Nothing is Rendered there)
+	if (IsLocallyControlled() || GetNetMode() == NM_DedicatedServer)
+		return;
+
+	// Update Speed Trails (Boost also Changes the Thrust Flames)
+	bBoostActive = VisualState.HasFlag(FNetClientVisuals::BoostModeActive);
+	SetSpeedTrailVisuals();
+
+	// Update Thrust/Brake Flames
+	bMoving = VisualState.HasFlag(FNetClientVisuals::ActivateThrustOrBrakes);
+	bMoveDirectionForward = VisualState.HasFlag(FNetClientVisuals::MoveDirectionForward);
+	SetThrustFlameVisuals();
+
+	// Update Turning Flames
+	bTurning = VisualState.HasFlag(FNetClientVisuals::ActivateTurningFlames);
+	bTurnDirectionRight = VisualState.HasFlag(FNetClientVisuals::TurnDirectionRight);
+	SetTurningFlameVisuals();
+
+	// Update Turret Rotation (Light Ridge Fades to the Lock In Color by itself)
+	bIsLockedIn = VisualState.HasFlag(FNetClientVisuals::IsLockedIn);
+	if (bIsLockedIn)
+	{
+		TurretMeshComp->SetWorldRotation(VisualState.GetTurretRotation());
 	}
-	CurrTickClientVisuals.bIsLockedIn = bIsLockedIn;
 }
 
 void ACombatVehicle::OnHealthUpdate()
@@ -907,13 +1113,13 @@ void ACombatVehicle::OnHealthUpdate()
 	// Client-side Actions
 	if (IsLocallyControlled())
 	{
-		UI_OnHealthUpdate(CurrentHealth);
+		UI_OnHealthUpdate(GetCurrentHealth());
 	}
 
 	// Server-side Actions
 	if (HasAuthority())
 	{
-		if (CurrentHealth <= 0)
+		if (GetCurrentHealth() <= 0)
 		{
 			// Let the Blueprint Handle Death Scenario
 			BP_PlayerDeath();
@@ -937,21 +1143,38 @@ void ACombatVehicle::OnHealthUpdate()
 
 void ACombatVehicle::SetCurrentHealth(float HealthValue)
 {
-	if (GetLocalRole() == ROLE_Authority)
+	// OnHealthUpdate is Called by the Attribute Change Delegate
+	if (GetLocalRole() == ROLE_Authority && AbilitySystemComp)
 	{
-		CurrentHealth = FMath::Clamp(HealthValue, 0.0f, MaxHealth);
-		OnHealthUpdate();
+		AbilitySystemComp->SetNumericAttributeBase(UCVAttributeSet::GetHealthAttribute(), HealthValue);
 	}
 }
 
 float ACombatVehicle::TakeDamage(float DamageTaken, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
-	float DamageApplied = CurrentHealth - DamageTaken;
-	LastShotBy = Cast<ACombatVehicle>(DamageCauser);
-	
-	SetCurrentHealth(DamageApplied);
+	// Same Damage Effect as Projectile Hits
+	ApplyQueuedDamage(DamageTaken, Cast<ACombatVehicle>(DamageCauser));
 
-	return DamageApplied;
+	return GetCurrentHealth();
+}
+
+bool ACombatVehicle::ApplyQueuedDamage(float TotalDamage, ACombatVehicle* LastShooter)
+{
+	if (!HasAuthority() || bDeathQueued || TotalDamage <= 0.0f || !AbilitySystemComp)
+		return false;
+
+	LastShotBy = LastShooter;
+
+	// Instigated by the Shooter's ASC, so Effects can Read Who Dealt it
+	UCVAbilitySystemComponent* SourceASC = LastShooter && LastShooter->GetAbilitySystemComponent() ? LastShooter->GetAbilitySystemComponent() : AbilitySystemComp;
+	FGameplayEffectContextHandle EffectContext = SourceASC->MakeEffectContext();
+	EffectContext.AddInstigator(LastShooter ? LastShooter->GetController() : nullptr, LastShooter);
+
+	FGameplayEffectSpec DamageSpec(GetDefault<UDamageGameplayEffect>(), EffectContext, 1.0f);
+	DamageSpec.SetSetByCallerMagnitude(TAG_Data_Damage, TotalDamage);
+	SourceASC->ApplyGameplayEffectSpecToTarget(DamageSpec, AbilitySystemComp);
+
+	return bDeathQueued;
 }
 
 void ACombatVehicle::ToggleLockIn()
@@ -971,6 +1194,7 @@ void ACombatVehicle::ToggleLockIn()
 		UI_SetLockedIn(true);
 
 		bIsLockedIn = true;
+		RPC_Server_SetLockedIn(true);
 	}
 	else
 	{
@@ -987,6 +1211,7 @@ void ACombatVehicle::ToggleLockIn()
 		UI_SetLockedIn(false);
 
 		bIsLockedIn = false;
+		RPC_Server_SetLockedIn(false);
 	}
 }
 
@@ -996,7 +1221,11 @@ void ACombatVehicle::StartShooting()
 	{
 		bIsShooting = true;
 
-		GetWorld()->GetTimerManager().SetTimer(FiringTimer, this, &ACombatVehicle::StopShooting, FireRate, false);
+		// Sustained Fire Shoots until the Input is Released
+		if (!bUseSustainedFire)
+		{
+			GetWorld()->GetTimerManager().SetTimer(FiringTimer, this, &ACombatVehicle::StopShooting, FireRate, false);
+		}
 		
 		// Ask Server to Spawn the Projectile
 		if (AbilitySystemComp)
@@ -1011,22 +1240,35 @@ void ACombatVehicle::StopShooting()
 	bIsShooting = false;
 }
 
-void ACombatVehicle::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+void ACombatVehicle::ReleaseShooting()
 {
-	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	if (!bUseSustainedFire || !bIsShooting)
+		return;
 
-	DOREPLIFETIME(ACombatVehicle, CurrentHealth);
-	DOREPLIFETIME(ACombatVehicle, ServerStats);
+	bIsShooting = false;
+	if (AbilitySystemComp)
+	{
+		AbilitySystemComp->ReleaseAbilityInputByClass(UShootingGameplayAbility::StaticClass());
+	}
 }
 
-void ACombatVehicle::OnRep_CurrentHealth()
+void ACombatVehicle::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-	OnHealthUpdate();
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	constexpr bool bUsePushModel = true;
+
+	FDoRepLifetimeParams PushParams{ COND_None, REPNOTIFY_OnChanged, bUsePushModel };
+	DOREPLIFETIME_WITH_PARAMS_FAST(ACombatVehicle, ServerStats, PushParams);
+
+	// The Owner already Shows its own Visuals
+	FDoRepLifetimeParams SkipOwnerParams{ COND_SkipOwner, REPNOTIFY_OnChanged, bUsePushModel };
+	DOREPLIFETIME_WITH_PARAMS_FAST(ACombatVehicle, VisualState, SkipOwnerParams);
 }
 
 void ACombatVehicle::OnRep_ServerStats()
 {
-	// Handles Autonomous Proxy (Owning Client)
+	// Handles Autonomous Proxy (Owning Client) and Simulated Proxies
 	//
 
 	if (IsLocallyControlled() && GetLocalRole() == ROLE_AutonomousProxy)
@@ -1034,89 +1276,149 @@ void ACombatVehicle::OnRep_ServerStats()
 		// Client needs to Reconcile its Movement with the Server's
 		//
 
-		// Check if Location Error is Large Enough
-		FVector LocError = GetActorLocation() - ServerStats.Location;
-
-		// Reset Movement according to Server Authorized Parameters if Error exceeds Threshold
-		bShouldReconcileMovement = LocError.SizeSquared() > MaxNetPredictionError * MaxNetPredictionError;
-		
 		// Remove Acknowledged Moves
-		NetClientPredStats.RemoveAcknowledgedMoves(ServerStats.Timestamp);
+		NetClientPredStats.RemoveAcknowledgedMoves(ServerStats.AckSequence);
+
+		// Rewind to the Server's State and Replay the Remaining Moves
+		ReplayUnacknowledgedMoves();
+	}
+	else if (GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		// Buffer for Interpolation, Stamped with the Server's Simulation Time (One Fixed Step per Acknowledged Move)
+		FVehicleSnapshot Snapshot;
+		Snapshot.Time = static_cast<double>(ServerStats.AckSequence) * MovementParams.FixedStepSeconds;
+		Snapshot.Location = ServerStats.Location;
+		Snapshot.Rotation = ServerStats.Rotation;
+		Snapshot.Velocity = ServerStats.Velocity;
+		Snapshot.YawVelocity = ServerStats.YawVelocity;
+		SnapshotBuffer.AddSnapshot(Snapshot, GetWorld()->GetTimeSeconds());
 	}
 }
 
-void ACombatVehicle::RPC_Multicast_UpdateVisuals_Implementation(FNetClientVisuals NewVisuals)
+void ACombatVehicle::OnRep_VisualState()
 {
-	// Don't Run on Local Client
-	if (IsLocallyControlled())
+	ApplyVisualState();
+}
+
+void ACombatVehicle::RPC_Server_UpdateVisuals_Implementation(FNetClientVisuals NewVisuals)
+{
+	if (VisualState == NewVisuals)
 		return;
 
-	// Update Light Ridge
-	LightRidgeMaterial->SetVectorParameterValue("LightColor", NewVisuals.CurrLightRidgeColor);
-	
-	// Update Jet Flame
-	JetFlameCenterMeshComp->SetRelativeScale3D(NewVisuals.JetFlameCenterScale);
-	JetFlameCenterMeshComp->SetRelativeLocation(JetFlameCenterPosition);
+	VisualState = NewVisuals;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ACombatVehicle, VisualState, this);
 
-	JetFlameRightMeshComp->SetRelativeScale3D(NewVisuals.JetFlameRightScale);
-	JetFlameRightMeshComp->SetRelativeLocation(JetFlameRightPosition);
+	// Listen Server won't get the RepNotify
+	ApplyVisualState();
+}
 
-	JetFlameLeftMeshComp->SetRelativeScale3D(NewVisuals.JetFlameLeftScale);
-	JetFlameLeftMeshComp->SetRelativeLocation(JetFlameLeftPosition);
+void ACombatVehicle::RPC_Server_SetLockedIn_Implementation(bool bLockedIn)
+{
+	if (bServerLockedIn == bLockedIn)
+		return;
 
-	// Update Thrust/Brake Flames
-	bMoving = NewVisuals.bActivateThrustOrBrakes;
-	bMoveDirectionForward = NewVisuals.bMoveDirectionForward;
-	SetThrustFlameVisuals();
+	bServerLockedIn = bLockedIn;
+	if (bLockedIn)
+	{
+		ServerLockInTime = GetWorld()->GetTimeSeconds();
+	}
+	else
+	{
+		ServerUnlockTime = GetWorld()->GetTimeSeconds();
+	}
+}
 
-	// Update Turning Flames
-	bTurning = NewVisuals.bActivateTurningFlames;
-	bTurnDirectionRight = NewVisuals.bTurnDirectionRight;
-	SetTurningFlameVisuals();
+void ACombatVehicle::RPC_Server_UpdateMoves_Implementation(FNetClientMoveBatch MoveBatch)
+{
+	// The First Move from a Fresh Client is Sequence 1, so nothing counts as Missed before it
+	if (ServerAckSequence == 0 && MoveBatch.Moves.Num() > 0)
+	{
+		ServerAckSequence = MoveBatch.Moves[0].Sequence - 1;
+	}
 
-	// Update Turret Rotation
-	if (NewVisuals.bIsLockedIn)
+	// Refill the Move Budget by the Server Time Elapsed, a Client can't Move Faster than the Step Rate
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float MaxMoveBudget = FMath::Max(MovementStepRate * ServerMoveBurstSeconds, 1.0f);
+	if (ServerMoveBudget < 0.0f)
 	{
-		TurretMeshComp->SetWorldRotation(NewVisuals.TurretRotation);
+		ServerMoveBudget = MaxMoveBudget;
 	}
+	else
+	{
+		ServerMoveBudget = FMath::Min(ServerMoveBudget + static_cast<float>(Now - ServerMoveBudgetTime) * MovementStepRate * ServerMoveRateTolerance, MaxMoveBudget);
+	}
+	ServerMoveBudgetTime = Now;
 
-	// Update Speed Trails
-	bBoostActive = NewVisuals.bBoostModeActive;
-	SetSpeedTrailVisuals();
+	int32 NumApplied = 0;
+	int32 NumThrottled = 0;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ServerApplyMoves);
+		for (int32 i = 0; i < MoveBatch.Moves.Num(); ++i)
+		{
+			const FNetClientMove& Move = MoveBatch.Moves[i];
+			const bool bNewMove = static_cast<int32>(Move.Sequence - ServerAckSequence) > 0;
+			if (bNewMove && ServerMoveBudget < 1.0f)
+			{
+				// Over Budget: this Move and the Rest stay Unacknowledged, Resent while they're among the Client's Newest
+				NumThrottled = MoveBatch.Moves.Num() - i;
+				break;
+			}
+
+			if (ServerApplyMove(Move))
+			{
+				++NumApplied;
+				ServerMoveBudget -= 1.0f;
+			}
+		}
+	}
+
+	// Per-Connection Stats
+	++NetMoveBatchStats.NumBatches;
+	NetMoveBatchStats.NumMovesReceived += MoveBatch.Moves.Num();
+	NetMoveBatchStats.NumMovesApplied += NumApplied;
+	NetMoveBatchStats.NumRedundantMoves += MoveBatch.Moves.Num() - NumApplied - NumThrottled;
+	NetMoveBatchStats.NumMovesThrottled += NumThrottled;
+	NetMoveBatchStats.PayloadBits += MoveBatch.GetNumPayloadBits();
 }
 
-void ACombatVehicle::RPC_Server_UpdateVisuals_Implementation(FNetClientVisuals NewVisuals)
+void ACombatVehicle::ShowImpact(const FVector& LocalLocation, const FVector& LocalNormal, const FVector& DecalTexSize)
 {
-	RPC_Multicast_UpdateVisuals(NewVisuals);
+	// Decals Project along their X Axis, into the Surface
+	const FTransform& VehicleTransform = GetActorTransform();
+	const FVector Location = VehicleTransform.TransformPosition(LocalLocation);
+	const FRotator Rotation = (-VehicleTransform.TransformVectorNoScale(LocalNormal)).Rotation();
+	GetWorld()->GetSubsystem<UImpactDecalSubsystem>()->SpawnDecal(this, Location, Rotation, DecalTexSize);
+
+	if (IsLocallyControlled())
+	{
+		// Display Hit Effect
+		GetWorld()->GetSubsystem<UVehicleVisualsSubsystem>()->PlayHitEffect(this);
+	}
 }
 
-void ACombatVehicle::RPC_Server_UpdateMovement_Implementation(FNetClientMove ClientMove)
+void ACombatVehicle::RPC_Multicast_SpawnProjectileVisual_Implementation(TSubclassOf<AProjectile> ProjectileClass, FVector_NetQuantize Location, FVector_NetQuantize Velocity)
 {
-	// Apply the Move on the Remote Actor
-	UpdateMovement(ClientMove);
+	if (IsLocallyControlled() || GetNetMode() == NM_DedicatedServer)
+		return;
 
-	// Update Server Stats (Replicated Property)
-	ServerStats.Location = GetActorLocation();
-	ServerStats.Rotation = GetActorRotation();
-	ServerStats.Velocity = GetVelocity();
-	ServerStats.Timestamp = ClientMove.Timestamp;
+	SpawnProjectileVisual(ProjectileClass, Location, Velocity);
 }
 
-void ACombatVehicle::RPC_Multicast_SpawnDecal_Implementation(FVector Location, FRotator Rotation, FVector DecalTexSize)
+AProjectile* ACombatVehicle::SpawnProjectileVisual(TSubclassOf<AProjectile> ProjectileClass, const FVector& Location, const FVector& Velocity)
 {
-	UDecalComponent* DecalComp = UGameplayStatics::SpawnDecalAttached(DecalMaterial, DecalTexSize, MeshComp, NAME_None, Location,
-		Rotation, EAttachLocation::KeepWorldPosition, 5.0f);
-	DecalComp->SetFadeScreenSize(0.0f);
+	UProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UProjectilePoolSubsystem>();
+	if (!ProjectileClass || !Pool || !UProjectilePoolSubsystem::CanPoolProjectiles(GetWorld()))
+		return nullptr;
 
-	if (IsLocallyControlled())
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Instigator = this;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AProjectile* Projectile = Pool->AcquireProjectile(ProjectileClass, Location, Velocity.Rotation(), SpawnParams);
+	if (Projectile && Projectile->ProjectileMovement)
 	{
-		// Display Hit Effect
-		HitEffectFadeTimer = 1.0f;
-		HitEffectMaterial->SetScalarParameterValue("Alpha", HitEffectFadeTimer);
+		Projectile->ProjectileMovement->Velocity = Velocity;
 	}
-}
 
-void ACombatVehicle::RPC_Server_SpawnDecal_Implementation(FVector Location, FRotator Rotation, FVector DecalTexSize)
-{
-	RPC_Multicast_SpawnDecal(Location, Rotation, DecalTexSize);
+	return Projectile;
 }
\ No newline at end of file
@@ -6,6 +6,10 @@
 #include "GameFramework/Pawn.h"
 
 #include "ACPlayerState.h"
+#include "VehicleMovementModel.h"
+#include "VehicleSnapshotBuffer.h"
+#include "VehiclePoseHistory.h"
+#include "Engine/NetSerialization.h"
 
 // Niagara System
 #include "NiagaraFunctionLibrary.h"
@@ -20,7 +24,7 @@ struct FNetClientMove
 	GENERATED_BODY()
 
 	UPROPERTY()
-	float Timestamp = 0.0f;
+	uint32 Sequence = 0; // Consecutive Move Number, used for Acknowledging Moves
 
 	UPROPERTY()
 	float InputVertical = 0.0f; // Deals with Asceding/Descending
@@ -36,50 +40,191 @@ struct FNetClientMove
 
 	UPROPERTY()
 	FRotator BoostRotation = FRotator(); // Boost Mode Rotation (Need this to relieve Server of Computing Rotations in Boost Mode)
+
+	// Inputs can only be -1, 0 or 1, so each one is Packed into 2 Bits (Boost into 1)
+	void SerializeInputs(FArchive& Ar)
+	{
+		uint8 PackedInputs = 0;
+		if (Ar.IsSaving())
+		{
+			PackedInputs = PackAxis(InputVertical) | (PackAxis(InputForward) << 2) | (PackAxis(InputSteering) << 4) | ((InputBoost > 0.0f ? 1 : 0) << 6);
+		}
+		Ar.SerializeBits(&PackedInputs, 7);
+		if (Ar.IsLoading())
+		{
+			InputVertical = UnpackAxis(PackedInputs);
+			InputForward = UnpackAxis(PackedInputs >> 2);
+			InputSteering = UnpackAxis(PackedInputs >> 4);
+			InputBoost = (PackedInputs >> 6) & 1 ? 1.0f : 0.0f;
+		}
+
+		// Yaw is Integrated by the Server, only the Boost Tilt is Needed (and it's Zero outside Boost Mode)
+		uint16 ShortPitch = FRotator::CompressAxisToShort(BoostRotation.Pitch);
+		uint16 ShortRoll = FRotator::CompressAxisToShort(BoostRotation.Roll);
+		uint8 bTilted = (ShortPitch != 0 || ShortRoll != 0) ? 1 : 0;
+		Ar.SerializeBits(&bTilted, 1);
+		if (bTilted)
+		{
+			Ar << ShortPitch;
+			Ar << ShortRoll;
+		}
+		else
+		{
+			ShortPitch = 0;
+			ShortRoll = 0;
+		}
+
+		if (Ar.IsLoading())
+		{
+			BoostRotation = FRotator(FRotator::DecompressAxisFromShort(ShortPitch), 0.0f, FRotator::DecompressAxisFromShort(ShortRoll));
+		}
+	}
+
+	// Round the Boost Tilt to what the Server will Receive, so Client Prediction uses the Same Inputs
+	void QuantizeBoostRotation()
+	{
+		BoostRotation.Pitch = FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(BoostRotation.Pitch));
+		BoostRotation.Roll = FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(BoostRotation.Roll));
+	}
+
+private:
+	static uint8 PackAxis(float Value)
+	{
+		return Value > 0.0f ? 1 : (Value < 0.0f ? 2 : 0);
+	}
+
+	static float UnpackAxis(uint8 Packed)
+	{
+		switch (Packed & 3)
+		{
+		case 1: return 1.0f;
+		case 2: return -1.0f;
+		default: return 0.0f;
+		}
+	}
 };
 
+// Moves sent to the Server in a Single RPC. Carries the Newest Unacknowledged Moves (up to a Cap), so a Lost Packet is covered by the Next one.
 USTRUCT()
-struct FNetClientPredStats
+struct FNetClientMoveBatch
 {
 	GENERATED_BODY()
 
-	UPROPERTY()
-	TArray<FNetClientMove> MoveQueue;
+	// Upper Bound on Moves accepted from a Single Packet
+	static constexpr uint32 MaxMovesPerBatch = 64;
 
+	// Moves with Consecutive Sequence Numbers (Oldest First)
 	UPROPERTY()
-	int MaxMovesInQueue = 64;
+	TArray<FNetClientMove> Moves;
 
-public:
-	FNetClientPredStats() : MoveQueue()
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		// Sequence Numbers are Consecutive, so only the First one is Sent
+		uint32 BaseSequence = Moves.Num() > 0 ? Moves[0].Sequence : 0;
+		uint32 NumMoves = Moves.Num();
+		Ar.SerializeIntPacked(BaseSequence);
+		Ar.SerializeIntPacked(NumMoves);
+
+		if (Ar.IsLoading())
+		{
+			if (NumMoves > MaxMovesPerBatch)
+			{
+				bOutSuccess = false;
+				return true;
+			}
+			Moves.SetNum(NumMoves);
+		}
+
+		for (uint32 i = 0; i < NumMoves; ++i)
+		{
+			Moves[i].Sequence = BaseSequence + i;
+			Moves[i].SerializeInputs(Ar);
+		}
+
+		bOutSuccess = true;
+		return true;
+	}
+
+	// Bits NetSerialize Writes for this Batch, Counted without Serializing it
+	int32 GetNumPayloadBits() const
 	{
-		MoveQueue.Reserve(MaxMovesInQueue);
+		int32 NumBits = GetPackedIntBits(Moves.Num() > 0 ? Moves[0].Sequence : 0) + GetPackedIntBits(Moves.Num());
+		for (const FNetClientMove& Move : Moves)
+		{
+			// Packed Inputs, Tilt Flag and (if Tilted) Pitch and Roll
+			const bool bTilted = FRotator::CompressAxisToShort(Move.BoostRotation.Pitch) != 0 || FRotator::CompressAxisToShort(Move.BoostRotation.Roll) != 0;
+			NumBits += 7 + 1 + (bTilted ? 32 : 0);
+		}
+		return NumBits;
 	}
 
-	bool IsMoveQueueEmpty()
+private:
+	// SerializeIntPacked Writes 7 Value Bits per Byte
+	static int32 GetPackedIntBits(uint32 Value)
 	{
-		return (MoveQueue.Num() == 0);
+		return 8 * (Value == 0 ? 1 : static_cast<int32>(FMath::FloorLog2(Value)) / 7 + 1);
 	}
+};
 
-	int GetNumOfMoves()
+template<>
+struct TStructOpsTypeTraits<FNetClientMoveBatch> : public TStructOpsTypeTraitsBase2<FNetClientMoveBatch>
+{
+	enum
 	{
-		return MoveQueue.Num();
+		WithNetSerializer = true
+	};
+};
+
+// Fixed-Capacity Circular Buffer of Moves (Oldest Move lives at MoveQueueHead). Capacity is a Power of Two, so
+// Indices Wrap with a Mask and the Moves live inline (no Allocation)
+template<int32 Capacity>
+struct TNetMoveQueue
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Move Queue Capacity must be a Power of Two");
+
+	static constexpr int32 MaxMovesInQueue = Capacity;
+
+	bool IsMoveQueueEmpty() const
+	{
+		return (NumMovesInQueue == 0);
 	}
 
-	// Enqueue a Move
-	void AddMove(FNetClientMove& Move)
+	int GetNumOfMoves() const
 	{
-		if (MoveQueue.Num() < MaxMovesInQueue)
+		return NumMovesInQueue;
+	}
+
+	// Access Moves from Oldest (0) to Newest (GetNumOfMoves() - 1)
+	const FNetClientMove& GetMove(int Index) const
+	{
+		check(Index >= 0 && Index < NumMovesInQueue);
+		return MoveQueue[WrapIndex(MoveQueueHead + Index)];
+	}
+
+	// Copy the Newest Moves (up to MaxMoves) into OutMoves, Oldest of them First. The Newest Input is always Included,
+	// whatever the Acknowledged Backlog.
+	void GetNewestMoves(int32 MaxMoves, TArray<FNetClientMove>& OutMoves) const
+	{
+		const int NumToCopy = FMath::Clamp(MaxMoves, 0, NumMovesInQueue);
+		OutMoves.Reset(NumToCopy);
+		for (int i = NumMovesInQueue - NumToCopy; i < NumMovesInQueue; ++i)
 		{
-			MoveQueue.Add(Move);
+			OutMoves.Add(MoveQueue[WrapIndex(MoveQueueHead + i)]);
 		}
-		else 
-		{
-			// Remove Last Move
-			MoveQueue.RemoveAt(0);
+	}
 
-			// Add New Move
-			MoveQueue.Add(Move);
+	// Enqueue a Move
+	void AddMove(const FNetClientMove& Move)
+	{
+		if (NumMovesInQueue == Capacity)
+		{
+			// Overwrite the Oldest Move
+			MoveQueueHead = WrapIndex(MoveQueueHead + 1);
+			--NumMovesInQueue;
 		}
+
+		MoveQueue[WrapIndex(MoveQueueHead + NumMovesInQueue)] = Move;
+		++NumMovesInQueue;
 	}
 
 	// Dequeue Moves
@@ -89,37 +234,51 @@ public:
 		if (IsMoveQueueEmpty())
 			return FNetClientMove();
 
-		FNetClientMove Move = MoveQueue[0];
-		MoveQueue.RemoveAt(0);
+		FNetClientMove Move = MoveQueue[MoveQueueHead];
+		MoveQueueHead = WrapIndex(MoveQueueHead + 1);
+		--NumMovesInQueue;
 		return Move;
 	}
 
 	// Update Client for Acknowledged Moves
-	void RemoveAcknowledgedMoves(float AckTimestamp)
+	// Moves are Enqueued with consecutive Sequence Numbers, so the whole Acknowledged Prefix is dropped in one step
+	void RemoveAcknowledgedMoves(uint32 AckSequence)
 	{
-		int i = 0;
-		while (i < MoveQueue.Num())
-		{
-			if (MoveQueue[i].Timestamp <= AckTimestamp)
-			{
-				MoveQueue.RemoveAt(i);
-			}
-			else
-			{
-				++i;
-			}
-		}
+		if (IsMoveQueueEmpty())
+			return;
+
+		// Signed Difference handles Sequence Number Wrap-Around
+		const int32 NumAcked = static_cast<int32>(AckSequence - MoveQueue[MoveQueueHead].Sequence) + 1;
+		if (NumAcked <= 0)
+			return;
+
+		const int NumToRemove = FMath::Min(NumAcked, NumMovesInQueue);
+		MoveQueueHead = WrapIndex(MoveQueueHead + NumToRemove);
+		NumMovesInQueue -= NumToRemove;
+	}
+
+private:
+	static int WrapIndex(int Index)
+	{
+		return Index & (Capacity - 1);
 	}
+
+	FNetClientMove MoveQueue[Capacity];
+	int MoveQueueHead = 0;
+	int NumMovesInQueue = 0;
 };
 
+// Moves the Client Predicted that the Server hasn't Acknowledged yet
+using FNetClientPredStats = TNetMoveQueue<64>;
+
 USTRUCT()
 struct FNetServerStats // Holds the Last Movement Data for the Vehicle validated by the Server
 {
 	GENERATED_BODY()
-	
-	UPROPERTY()
-	float Timestamp = 0.0f;
 
+	UPROPERTY()
+	uint32 AckSequence = 0; // Sequence Number of the Last Move applied by the Server
+	
 	UPROPERTY() 
 	FVector Location = FVector();
 	
@@ -128,46 +287,240 @@ struct FNetServerStats // Holds the Last Movement Data for the Vehicle validated
 	
 	UPROPERTY() 
 	FVector Velocity = FVector();
-	
+
+	UPROPERTY()
+	float YawVelocity = 0.0f; // Degrees per Second
+
+	// Hover Wobble State (Needed to Replay Moves from this State)
+	UPROPERTY()
+	float HoverTime = 0.0f;
+
+	UPROPERTY()
+	float HoverMaxVelocity = 0.0f;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		Ar.SerializeIntPacked(AckSequence);
+
+		// Same Precision as FVector_NetQuantize100 (Location) and FVector_NetQuantize10 (Velocity)
+		bOutSuccess = SerializePackedVector<100, 30>(Location, Ar);
+		bOutSuccess &= SerializePackedVector<10, 24>(Velocity, Ar);
+		Rotation.SerializeCompressedShort(Ar);
+
+		SerializeFixedFloat<128, 16>(YawVelocity, Ar); // +-256
+		SerializeFixedFloat<512, 16>(HoverTime, Ar); // +-64
+		SerializeFixedFloat<64, 20>(HoverMaxVelocity, Ar); // +-8192
+
+		return true;
+	}
+
+	// Copy the Kinematic State (everything but the Ack)
+	void SetMovementState(const FVehicleMovementState& State)
+	{
+		Location = State.Location;
+		Rotation = State.Rotation;
+		Velocity = State.Velocity;
+		YawVelocity = State.YawVelocity;
+		HoverTime = State.HoverTime;
+		HoverMaxVelocity = State.HoverMaxVelocity;
+	}
+
+	FVehicleMovementState GetMovementState() const
+	{
+		FVehicleMovementState State;
+		State.Location = Location;
+		State.Rotation = Rotation;
+		State.Velocity = Velocity;
+		State.YawVelocity = YawVelocity;
+		State.HoverTime = HoverTime;
+		State.HoverMaxVelocity = HoverMaxVelocity;
+		return State;
+	}
+
+	// Whether State Differs from this (Quantized) one at Replicated Precision. HoverTime keeps Counting while Hovering,
+	// it only Matters while the Wobble still Moves the Vehicle, so it's Left out.
+	bool DiffersFrom(const FVehicleMovementState& State) const
+	{
+		FNetServerStats Candidate;
+		Candidate.SetMovementState(State);
+		Candidate.Quantize();
+
+		return Candidate.Location != Location || Candidate.Rotation != Rotation || Candidate.Velocity != Velocity
+			|| Candidate.YawVelocity != YawVelocity || Candidate.HoverMaxVelocity != HoverMaxVelocity;
+	}
+
+	// Round every Field to what NetSerialize Sends, without Serializing (Server and Owning Client then Replay from the Same State)
+	void Quantize()
+	{
+		Location = QuantizeVector<100>(Location);
+		Velocity = QuantizeVector<10>(Velocity);
+		Rotation = FRotator(FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(Rotation.Pitch)),
+			FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(Rotation.Yaw)),
+			FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(Rotation.Roll)));
+		YawVelocity = FromFixed<128>(ToFixed<128, 16>(YawVelocity));
+		HoverTime = FromFixed<512>(ToFixed<512, 16>(HoverTime));
+		HoverMaxVelocity = FromFixed<64>(ToFixed<64, 20>(HoverMaxVelocity));
+	}
+
+private:
+	template<int32 Scale>
+	static FVector QuantizeVector(const FVector& Value)
+	{
+		return FVector(FMath::RoundToDouble(Value.X * Scale), FMath::RoundToDouble(Value.Y * Scale), FMath::RoundToDouble(Value.Z * Scale)) / Scale;
+	}
+
+	// Fixed Point: Value * Scale Rounded into a Signed NumBits Integer (Clamped to its Range)
+	template<int32 Scale, int32 NumBits>
+	static int32 ToFixed(float Value)
+	{
+		constexpr int32 MaxFixed = (1 << (NumBits - 1)) - 1;
+		return FMath::Clamp(FMath::RoundToInt(Value * Scale), -MaxFixed, MaxFixed);
+	}
+
+	template<int32 Scale>
+	static float FromFixed(int32 Fixed)
+	{
+		return static_cast<float>(Fixed) / Scale;
+	}
+
+	template<int32 Scale, int32 NumBits>
+	static void SerializeFixedFloat(float& Value, FArchive& Ar)
+	{
+		constexpr int32 Bias = 1 << (NumBits - 1);
+		uint32 Biased = static_cast<uint32>(ToFixed<Scale, NumBits>(Value) + Bias);
+		Ar.SerializeBits(&Biased, NumBits);
+		if (Ar.IsLoading())
+		{
+			Value = FromFixed<Scale>(static_cast<int32>(Biased) - Bias);
+		}
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FNetServerStats> : public TStructOpsTypeTraitsBase2<FNetServerStats>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+// Per-Connection Move Batching Stats (Counted on the Server)
+struct FNetMoveBatchStats
+{
+	int32 NumBatches = 0; // RPCs Received
+	int32 NumMovesReceived = 0; // Including Redundant Copies
+	int32 NumMovesApplied = 0;
+	int32 NumRedundantMoves = 0; // Already Applied from an Earlier Batch
+	int32 NumMovesMissed = 0; // Lost in more Consecutive Packets than the Redundancy covers
+	int32 NumMovesThrottled = 0; // Over the Server's Move Rate Budget (Left Unacknowledged)
+
+	int64 PayloadBits = 0;
+
+	// One RPC per Move was Sent before Batching
+	int32 GetNumRPCsSaved() const { return NumMovesApplied - NumBatches; }
+};
+
+// Client-side Reconciliation Stats
+struct FNetReconcileStats
+{
+	int32 NumReplays = 0;
+	int32 NumReplayedMoves = 0;
+	int32 NumCorrections = 0; // Replays whose Error exceeded MaxNetPredictionError
+
+	float LastCorrectionError = 0.0f;
+	float MaxCorrectionError = 0.0f;
+	float TotalCorrectionError = 0.0f;
 };
 
 USTRUCT()
-struct FNetClientVisuals
+struct FNetClientVisuals // Only the Inputs of the Visuals (Remote Clients derive Flames, Light Ridge Color and Trails Locally)
 {
 	GENERATED_BODY()
 
-	UPROPERTY()
-	FRotator TurretRotation = FRotator();
+	enum EFlags : uint8
+	{
+		ActivateThrustOrBrakes = 1 << 0,
+		MoveDirectionForward = 1 << 1, // To be used with `ActivateThrustOrBrakes`
+		ActivateTurningFlames = 1 << 2,
+		TurnDirectionRight = 1 << 3, // To be used with `ActivateTurningFlames`
+		IsLockedIn = 1 << 4,
+		BoostModeActive = 1 << 5,
 
-	UPROPERTY()
-	FLinearColor CurrLightRidgeColor;
+		NumFlagBits = 6
+	};
 
 	UPROPERTY()
-	FVector JetFlameCenterScale;
-	
-	UPROPERTY()
-	FVector JetFlameRightScale;
-	
-	UPROPERTY()
-	FVector JetFlameLeftScale;
+	uint8 Flags = 0;
 
+	// Turret World Rotation (Compressed, only Valid while Locked In)
 	UPROPERTY()
-	bool bActivateThrustOrBrakes = false;
+	uint16 TurretYaw = 0;
 
 	UPROPERTY()
-	bool bMoveDirectionForward = false; // To be used with `bActivateThrustOrBrakes`
+	uint16 TurretRoll = 0;
 
-	UPROPERTY()
-	bool bActivateTurningFlames = false;
+	bool HasFlag(uint8 Flag) const
+	{
+		return (Flags & Flag) != 0;
+	}
 
-	UPROPERTY()
-	bool bTurnDirectionRight = false; // To be used with `bActivateTurningFlames`
+	void SetFlag(uint8 Flag, bool bValue)
+	{
+		Flags = bValue ? (Flags | Flag) : (Flags & ~Flag);
+	}
 
-	UPROPERTY()
-	bool bIsLockedIn = false;
-	
-	UPROPERTY()
-	bool bBoostModeActive = false;
+	void SetTurretRotation(const FRotator& Rotation)
+	{
+		TurretYaw = FRotator::CompressAxisToShort(Rotation.Yaw);
+		TurretRoll = FRotator::CompressAxisToShort(Rotation.Roll);
+	}
+
+	FRotator GetTurretRotation() const
+	{
+		return FRotator(0.0f, FRotator::DecompressAxisFromShort(TurretYaw), FRotator::DecompressAxisFromShort(TurretRoll));
+	}
+
+	bool operator==(const FNetClientVisuals& Other) const
+	{
+		return Flags == Other.Flags && TurretYaw == Other.TurretYaw && TurretRoll == Other.TurretRoll;
+	}
+
+	bool operator!=(const FNetClientVisuals& Other) const
+	{
+		return !(*this == Other);
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		Ar.SerializeBits(&Flags, NumFlagBits);
+		if (HasFlag(IsLockedIn))
+		{
+			Ar << TurretYaw;
+			Ar << TurretRoll;
+		}
+
+		bOutSuccess = true;
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FNetClientVisuals> : public TStructOpsTypeTraitsBase2<FNetClientVisuals>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
+
+// Offsets of a Thruster's User Parameters in its Override Parameter Store (INDEX_NONE if the System doesn't Expose one)
+struct FThrusterParameterOffsets
+{
+	int32 SpawnRate = INDEX_NONE;
+	int32 ThrustColor = INDEX_NONE;
+	int32 MaxLifeTime = INDEX_NONE;
 };
 
 
@@ -225,9 +578,66 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle")
 	float MaxTurningSpeed = 40.0f;
 
+	// Movement is Simulated in Fixed Steps at this Rate, independent of the Frame Rate
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle")
+	float MovementStepRate = 60.0f;
+
+	// Upper Bound of Steps Simulated in a Single Frame (Avoids Spiralling on Slow Frames)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle")
+	int32 MaxMovementStepsPerFrame = 8;
+
+	// Predicted Location is Snapped to the Replayed Location if the Error exceeds this
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Network")
 	float MaxNetPredictionError = 50.0f;
 
+	// How often (per Second) the Client sends its Moves to the Server
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Network")
+	float NetMoveSendRate = 30.0f;
+
+	// Unchanged Visuals are Resent this often (in Seconds), as a Lost Change would otherwise stick until the Next one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Network")
+	float NetVisualsRefreshInterval = 1.0f;
+
+	// Upper Bound of Unacknowledged Moves Sent in a Batch (the Newest ones). Moves Sent in an Earlier Batch are Redundant Copies.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Network")
+	int32 NetMaxMovesPerBatch = 32;
+
+	// Server Accepts Moves at up to this Multiple of MovementStepRate (Rejects Speed Hacks, Tolerates Clock Drift)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Network")
+	float ServerMoveRateTolerance = 1.05f;
+
+	// Seconds of Moves the Server lets a Client Bank, to Absorb Bursts after a Hitch or Packet Loss
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Network")
+	float ServerMoveBurstSeconds = 0.5f;
+
+	// How often (per Second) the Server Publishes the Vehicle's Movement State (Never Faster than the Net Update Frequency)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Network")
+	float ServerStatsPublishRate = 30.0f;
+
+	// A Settled Vehicle still Publishes once the Ack is this many Moves Behind, so the Owning Client can Drop the Moves it Holds
+	// (Keep it under NetMaxMovesPerBatch, so a Batch still Covers every Unacknowledged Move)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Network")
+	int32 ServerAckPublishGap = 16;
+
+	// Net Update Frequency when Idle, Scaled up to the Max at Max Movement Velocity
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Network")
+	float MinNetUpdateFrequency = 15.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Network")
+	float MaxNetUpdateFrequency = 20.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Network")
+	float BoostNetUpdateFrequency = 30.0f;
+
+	// Remote Vehicles are Rendered this far (in Seconds) behind the Latest Server Update
+	// Raised to at least 1.5 Update Intervals at MinNetUpdateFrequency (see GetInterpolationDelay)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Network")
+	float InterpolationDelay = 0.1f;
+
+	// How long (in Seconds) a Remote Vehicle keeps Moving after the Server Updates Stop
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Network")
+	float MaxExtrapolationTime = 0.25f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Camera")
 	FVector2D NormalCameraPitchLimits = FVector2D(-90.0f, 90.0f);
 
@@ -244,6 +654,7 @@ public:
 	float WobbleFrequency = 2.5f;
 
 	// Health
+	// Written to the Player's UCVAttributeSet when the Vehicle is Possessed
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Health")
 	float MaxHealth = 100.0f;
 
@@ -270,10 +681,13 @@ public:
 	FLinearColor LightRidgeLockInColor = FColor::Red;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Visuals")
 	float LightRidgeLockInFadeFactor = 1.0f;
-	
-	FLinearColor CurrLightRidgeColor;
-	FLinearColor ActiveLightRidgeColor;
-	float LightRidgeLockInTimer = 0.0f;
+
+	// Light Ridge Material runs the Color Cycle itself: Lerp(ColorStart, ColorEnd, |Sin(Time - CycleStartTime)|),
+	// Blended with LightColor by CycleBlend. The CPU only Sends LightColor while Fading to/from the Lock In Color.
+	// Falls back to the CPU Cycle if the Material doesn't Expose CycleBlend and CycleStartTime.
+	// Off by default, the Shipped Light Ridge Material doesn't Expose them yet.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Visuals")
+	bool bLightRidgeCycleInMaterial = false;
 
 	// Post Process
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Visuals")
@@ -286,9 +700,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Visuals")
 	float SpeedTrailStopTime = 2.0f;
 
+	// Impact Decals Shown at once on this Vehicle
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Visuals")
+	int32 MaxImpactDecals = 8;
 
-	UPROPERTY(ReplicatedUsing = OnRep_CurrentHealth)
-	float CurrentHealth = 100.0f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Shooting")
 	float ProjectileSpawnOffsetDown = 10.0f;
@@ -308,6 +723,11 @@ public:
 	// If true, you are in the process of firing projectiles
 	bool bIsShooting;
 
+	// Hold Fire to Keep Shooting with One Ability Activation (Shots are Batched to the Server)
+	// Otherwise Every Shot Activates the Ability
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle | Shooting")
+	bool bUseSustainedFire = true;
+
 	bool bShouldHover = false;
 	bool bAscending = false;
 	bool bDescending = false;
@@ -323,10 +743,10 @@ public:
 
 	bool bIsClient = false;
 
-	float GameGravity = 980.0f;
-
-	float HoverTime = 0.0f;
-	float MaxVelAchieved = 0.0f;
+	// Movement Model (MeshComp only Mirrors MovementState)
+	FVehicleMovementParams MovementParams;
+	FVehicleMovementState MovementState;
+	float MovementStepAccumulator = 0.0f;
 
 	float BoostModeLastPitchAchieved = 0.0f;
 	float BoostModeLastRollAchieved = 0.0f;
@@ -340,10 +760,12 @@ public:
 	UMaterialInstanceDynamic* SpeedLinesMaterial;
 	float SpeedLinesLastWeight = 0.0f;
 	float SpeedLinesFadeTimer = 0.0f;
+	float SpeedLinesPushedAlpha = 0.0f;
+	int32 SpeedLinesAlphaIndex = INDEX_NONE;
 
 	// Post Process Material: Hit Effect
 	UMaterialInstanceDynamic* HitEffectMaterial;
-	float HitEffectFadeTimer = 0.0f;
+	int32 HitEffectAlphaIndex = INDEX_NONE;
 
 	// Speed Trail Timer
 	FTimerHandle SpeedTrailTimer;
@@ -355,18 +777,42 @@ public:
 	// Network
 	FNetClientPredStats NetClientPredStats;
 	FNetClientMove CurrTickClientMove;
-	FNetClientVisuals CurrTickClientVisuals;
+	uint32 NextMoveSequence = 1;
+	float NetMoveSendAccumulator = 0.0f;
+	FNetClientVisuals LastSentClientVisuals;
+	float NetVisualsSendAccumulator = 0.0f;
+	float NetVisualsRefreshTimer = 0.0f;
+	FNetReconcileStats NetReconcileStats;
+	FNetMoveBatchStats NetMoveBatchStats;
+	FVehicleSnapshotBuffer SnapshotBuffer; // Simulated Proxies only
+	FVehiclePoseHistory PoseHistory; // Server only, for Lag Compensation
+
+	// Server-side Publishing
+	uint32 ServerAckSequence = 0;
+	float ServerMoveBudget = -1.0f; // Moves the Client may still Send (Negative until the First Batch)
+	double ServerMoveBudgetTime = 0.0;
+	bool bServerStatsPending = false;
+	float ServerStatsPublishAccumulator = 0.0f;
+
+	// Server-side Lock In, Set by the Owning Client's Reliable RPC (the Visual State is Throttled and may be Lost)
+	bool bServerLockedIn = false;
+	double ServerLockInTime = 0.0;
+	double ServerUnlockTime = 0.0;
 	
 	// Server-side
 	UPROPERTY(ReplicatedUsing = OnRep_ServerStats)
 	FNetServerStats ServerStats;
 
-	bool bShouldReconcileMovement = false;
+	// Visual State of the Owning Client (Replicated to Everyone Else)
+	UPROPERTY(ReplicatedUsing = OnRep_VisualState)
+	FNetClientVisuals VisualState;
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// Component References
 	class UStaticMeshComponent* MeshComp;
 	class USpringArmComponent* SpringArmComp;
@@ -381,16 +827,14 @@ protected:
 	class UStaticMeshComponent* JetFlameRightMeshComp;
 	class UStaticMeshComponent* JetFlameLeftMeshComp;
 	FVector JetFlameCenterScale;
-	FVector JetFlameCenterPosition;
 	FVector JetFlameRightScale;
-	FVector JetFlameRightPosition;
 	FVector JetFlameLeftScale;
-	FVector JetFlameLeftPosition;
 
 	// Thrust and Brake Flame Visuals
 	UNiagaraComponent* ThrusterFlameCenterNS;
 	UNiagaraComponent* ThrusterFlameLeftNS;
 	UNiagaraComponent* ThrusterFlameRightNS;
+	FThrusterParameterOffsets ThrusterParameterOffsets[3]; // Center, Right, Left
 
 	UNiagaraComponent* BrakeFlameCenterNS;
 	UNiagaraComponent* BrakeFlameLeftNS;
@@ -402,7 +846,13 @@ protected:
 
 	// Light Ridge
 	UMaterialInstanceDynamic* LightRidgeMaterial;
-	float LightRidgeLerpTimer = 0.0f;
+	int32 LightRidgeColorIndex = INDEX_NONE;
+	int32 LightRidgeCycleStartIndex = INDEX_NONE;
+	int32 LightRidgeCycleBlendIndex = INDEX_NONE;
+
+	// Slot in UVehicleVisualsSubsystem (Time-Driven Visuals are Updated there)
+	int32 VisualsIndex = INDEX_NONE;
+	friend class UVehicleVisualsSubsystem;
 
 	// Speed Trail Visuals
 	UNiagaraComponent* SpeedTrailLeftNS;
@@ -411,9 +861,20 @@ protected:
 	// ASC (Initialized by ACPlayerState)
 	UCVAbilitySystemComponent* AbilitySystemComp;
 
+	// Health Lives in the Player State's Attribute Set (see OnHealthAttributeChanged)
+	const UCVAttributeSet* HealthAttributes = nullptr;
+	FDelegateHandle HealthChangedHandle;
+
 	// Projectile Decal Material
 	UMaterialInterface* DecalMaterial;
 
+	// Impact Decals (Ring Reused Oldest First, Managed by UImpactDecalSubsystem)
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<class UDecalComponent>> ImpactDecals;
+	int32 NextImpactDecal = 0;
+	TArray<int32> ImpactDecalLiveSlots; // Slot of each Decal in the Subsystem's Live Ring (INDEX_NONE if Hidden)
+	friend class UImpactDecalSubsystem;
+
 private:
 
 	UPROPERTY(EditDefaultsOnly, Category = "Input")
@@ -502,46 +963,92 @@ public:
 	UFUNCTION()
 	void ActivateBoost(const FInputActionValue& Value);
 
-	void UpdateMovement(FNetClientMove& Move);
+	// Advance the Vehicle by one Fixed Step using the Move's Inputs
+	void UpdateMovement(const FNetClientMove& Move);
 
-	// Hovering
-	UFUNCTION()
-	void ComputeHoverPhysics(float DeltaTime, float& VelZ, FVector& Force);
+	// Rewind to the Server's State and Re-apply every Unacknowledged Move
+	void ReplayUnacknowledgedMoves();
 
-	// Decelerating Forward/Backward Movement and Rotation
-	UFUNCTION()
-	void ComputeDeceleration(float DeltaTime, FVector& Force, FVector& Torque);
+	// Send the Newest Unacknowledged Moves to the Server
+	void SendMoveBatch();
+
+	// Apply a Client Move on the Server. Returns false if the Move was already Applied.
+	bool ServerApplyMove(const FNetClientMove& Move);
+	void UpdateServerStats();
+
+	// Copy the Server's State into ServerStats at the Publish Rate (only if Applied Moves Changed what would be Sent)
+	void PublishServerStats(float DeltaTime);
+
+	// Whether the Movement State Differs from the Last Published ServerStats at Replicated Precision
+	bool HasUnpublishedMovement() const;
+
+	// Whether the Applied Moves are ServerAckPublishGap or more ahead of the Last Published Ack
+	bool HasUnpublishedAck() const;
+
+	// Faster Vehicles are Replicated more Often
+	void UpdateNetUpdateFrequency();
+
+	// Where the Vehicle was at a Past Server Time (Lag Compensation). Returns false if there is no History yet.
+	bool GetRewoundTransform(double Time, FTransform& OutTransform) const;
+
+	// Offset of the Turret's Pivot from the Vehicle's Origin when the Vehicle has the given (e.g. Rewound) Transform
+	FVector GetTurretPivotOffset(const FTransform& VehicleTransform) const;
+
+	// Whether the Owning Client had Locked In at a Past Server Time (Shot Validation). Server only.
+	bool WasLockedInAt(double Time) const;
+
+	// Delay Remote Vehicles are Rendered with. Always covers the Slowest Update Interval plus Half of one for Jitter,
+	// otherwise a Slow Vehicle Runs past its Newest Snapshot between Updates.
+	float GetInterpolationDelay() const { return FMath::Max(InterpolationDelay, 1.5f / FMath::Max(MinNetUpdateFrequency, 1.0f)); }
+
+	// Movement Model Helpers
+	void UpdateMovementParams();
+	static FVehicleMoveInput MakeMoveInput(const FNetClientMove& Move);
+	void StepMovementState(FVehicleMovementState& State, const FNetClientMove& Move) const;
+	void MirrorMovementState();
 
 	// Boost Mode
 	void UpdateBoostMode(float DeltaTime);
 
-	// Vehicle Visuals
-	void UpdateLightRidgeColor(float DeltaTime);
-	void UpdateJetFlameVisuals(float DeltaTime);
+	// Vehicle Visuals (Light Ridge, Jet Flames and Hit Effect are Updated by UVehicleVisualsSubsystem)
 	void SetThrustFlameVisuals();
+	void CacheThrusterParameterOffsets();
+	void SetThrusterParameters(float SpawnRate, const FLinearColor& Color, float LifeTime); // Drives all Three Thrusters
 	void SetTurningFlameVisuals();
 	void SetSpeedTrailVisuals();
 	void StopSpeedTrailVisuals(); // Called by Timer
-	void UpdateHitEffect(float DeltaTime);
 
 	void UpdateTurretOrientation();
 
+	// Visuals Replication
+	FNetClientVisuals GatherClientVisuals() const;
+	void ApplyVisualState();
+
 	// Health
 	//
 	void OnHealthUpdate();
+
+	// Follows the Health Attribute of the Player State's ASC (Server and Clients)
+	void BindHealthAttribute();
+	void UnbindHealthAttribute();
+	void OnHealthAttributeChanged(const FOnAttributeChangeData& ChangeData);
 	
-	// Getters for Health variables
+	// Getters for Health variables (from the Attribute Set, the Vehicle's Defaults until it has one)
 	UFUNCTION(BlueprintPure, Category = "Vehicle | Health")
-	FORCEINLINE float GetMaxHealth() const { return MaxHealth; }
+	FORCEINLINE float GetMaxHealth() const { return HealthAttributes ? HealthAttributes->GetMaxHealth() : MaxHealth; }
 
 	UFUNCTION(BlueprintPure, Category = "Vehicle | Health")
-	FORCEINLINE float GetCurrentHealth() const { return CurrentHealth; }
+	FORCEINLINE float GetCurrentHealth() const { return HealthAttributes ? HealthAttributes->GetHealth() : MaxHealth; }
 
-	// Setter for Current Health. Clamps the value between 0 and MaxHealth and calls OnHealthUpdate. 
+	// Setter for Current Health. Sets the Health Attribute's Base Value, Clamped between 0 and MaxHealth by the Attribute Set.
 	// Should only be called on the server.
 	UFUNCTION(BlueprintCallable, Category = "Vehicle | Health")
 	void SetCurrentHealth(float HealthValue);
 
+	// Applies a Frame's Hits on this Vehicle at once: one Instant Damage Effect (UDamageGameplayEffect), and the Kill Credited 
+	// to LastShooter if it Dies. Returns whether it Died. Server only (see UServerProjectileSubsystem::ResolveDamage).
+	bool ApplyQueuedDamage(float TotalDamage, ACombatVehicle* LastShooter);
+
 	// Event for taking damage. Overridden from APawn.
 	UFUNCTION(BlueprintCallable, Category = "Vehicle | Health")
 	float TakeDamage(float DamageTaken, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
@@ -564,45 +1071,54 @@ public:
 	UFUNCTION()
 	void StopShooting();
 
+	// Fire Input Released, Ends Sustained Fire
+	UFUNCTION()
+	void ReleaseShooting();
+
 
 	// Replication
 	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
-	// Update Health
-	UFUNCTION()
-	void OnRep_CurrentHealth();
-
 	// Update Server Movement Stats
 	UFUNCTION()
 	void OnRep_ServerStats();
 
+	// Update Visuals of a Remote Vehicle
+	UFUNCTION()
+	void OnRep_VisualState();
+
 
 	// RPC Calls
 
 	// Notify Server About Movement
 	UFUNCTION(Server, Unreliable)
-	void RPC_Server_UpdateMovement(FNetClientMove ClientMove);
+	void RPC_Server_UpdateMoves(FNetClientMoveBatch MoveBatch);
 
 	// Notify Server About Shooting
 	/*UFUNCTION(Server, Unreliable)
 	void RPC_Server_HandleShooting(FVector SpawnPosition, FVector Direction);*/
 
-	// Notify Everyone About Visuals
+	// Notify Everyone About Visuals (Sent when they Change, and Refreshed in case a Change was Lost)
 	// Must be Called by CLIENT
 	UFUNCTION(Server, Unreliable)
 	void RPC_Server_UpdateVisuals(FNetClientVisuals NewVisuals);
 
-	// Notify Everyone About Visuals
-	// Must be Called by SERVER
-	UFUNCTION(NetMulticast, Unreliable)
-	void RPC_Multicast_UpdateVisuals(FNetClientVisuals NewVisuals);
+	// Notify Server About Locking In (Shots are only Accepted while Locked In)
+	// Must be Called by CLIENT
+	UFUNCTION(Server, Reliable)
+	void RPC_Server_SetLockedIn(bool bLockedIn);
 
-	// Projectile Decals
-	UFUNCTION(Server, Unreliable)
-	void RPC_Server_SpawnDecal(FVector Location, FRotator Rotation, FVector DecalTexSize);
+	// Projectile Impact (Decal, and Hit Effect on the Local Vehicle), Relative to this Vehicle
+	// Sent by the Server as an Impact Event (see AACPlayerController::QueueImpactEvent)
+	void ShowImpact(const FVector& LocalLocation, const FVector& LocalNormal, const FVector& DecalTexSize);
 
+	// Projectile Visuals for Everyone but the Shooter (who has its Fake Projectile)
+	// The Authoritative Round is Simulated by UServerProjectileSubsystem
 	UFUNCTION(NetMulticast, Unreliable)
-	void RPC_Multicast_SpawnDecal(FVector Location, FRotator Rotation, FVector DecalTexSize);
+	void RPC_Multicast_SpawnProjectileVisual(TSubclassOf<class AProjectile> ProjectileClass, FVector_NetQuantize Location, FVector_NetQuantize Velocity);
+
+	// Spawns a Local, Non-Replicated Projectile (Taken from the Projectile Pool)
+	class AProjectile* SpawnProjectileVisual(TSubclassOf<class AProjectile> ProjectileClass, const FVector& Location, const FVector& Velocity);
 
 	//
 	// Triggers for Blueprint Event
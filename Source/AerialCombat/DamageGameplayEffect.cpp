@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DamageGameplayEffect.h"
+#include "CVAttributeSet.h"
+
+UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_Data_Damage, "Data.Damage", "SetByCaller damage of UDamageGameplayEffect");
+
+UDamageGameplayEffect::UDamageGameplayEffect()
+{
+	DurationPolicy = EGameplayEffectDurationType::Instant;
+
+	FSetByCallerFloat SetByCallerDamage;
+	SetByCallerDamage.DataTag = TAG_Data_Damage;
+
+	FGameplayModifierInfo& DamageModifier = Modifiers.AddDefaulted_GetRef();
+	DamageModifier.Attribute = UCVAttributeSet::GetDamageAttribute();
+	DamageModifier.ModifierOp = EGameplayModOp::Additive;
+	DamageModifier.ModifierMagnitude = FGameplayEffectModifierMagnitude(SetByCallerDamage);
+}
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayEffect.h"
+#include "NativeGameplayTags.h"
+#include "DamageGameplayEffect.generated.h"
+
+/** SetByCaller magnitude of UDamageGameplayEffect: the damage to apply. */
+AERIALCOMBAT_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_Data_Damage);
+
+/**
+ * Instant effect adding its SetByCaller damage (TAG_Data_Damage) to the target's UCVAttributeSet::Damage meta
+ * attribute, which takes it off Health. Applied once per damaged vehicle per frame by ACombatVehicle::ApplyQueuedDamage,
+ * with the shooter as the effect causer.
+ */
+UCLASS()
+class AERIALCOMBAT_API UDamageGameplayEffect : public UGameplayEffect
+{
+	GENERATED_BODY()
+
+public:
+	UDamageGameplayEffect();
+};
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Totals a frame's hits per target in a single pass. Each target's hits count in arrival order until its health runs
+ * out (hits after the killing one don't count), and targets are kept in the order of their first hit. Finding a
+ * target's tally is a map lookup, so n hits cost O(n) whatever the number of targets.
+ *
+ * Only stores pointers to the targets and shooters, never dereferences them. Game thread only.
+ */
+template<typename TargetType>
+class TDamageTally
+{
+public:
+	struct FTargetTally
+	{
+		TargetType* Target = nullptr;
+		TargetType* LastShooter = nullptr; // Whose Hit Took the Last of its Health (or Landed Last)
+		float Health = 0.0f; // Left after the Counted Hits
+		float TotalDamage = 0.0f;
+		int32 NumHits = 0; // Counted Hits
+	};
+
+	/** Counts a hit on Target. GetTargetHealth is only called on its first hit, for its health before this frame. */
+	template<typename HealthFuncType>
+	void AddHit(TargetType* Target, TargetType* Shooter, float Damage, HealthFuncType&& GetTargetHealth)
+	{
+		int32& TallyIndex = TallyIndices.FindOrAdd(Target, INDEX_NONE);
+		if (TallyIndex == INDEX_NONE)
+		{
+			TallyIndex = Tallies.AddDefaulted();
+			Tallies[TallyIndex].Target = Target;
+			Tallies[TallyIndex].Health = GetTargetHealth();
+		}
+
+		FTargetTally& Tally = Tallies[TallyIndex];
+		if (Tally.Health > 0.0f)
+		{
+			Tally.Health -= Damage;
+			Tally.TotalDamage += Damage;
+			Tally.LastShooter = Shooter;
+			++Tally.NumHits;
+		}
+	}
+
+	/** One tally per target hit since the last Reset, in order of their first hit. */
+	const TArray<FTargetTally>& GetTallies() const { return Tallies; }
+
+	/** Forgets every tally, keeping the memory for the next frame. */
+	void Reset()
+	{
+		TallyIndices.Reset();
+		Tallies.Reset();
+	}
+
+private:
+	TMap<TargetType*, int32> TallyIndices;
+	TArray<FTargetTally> Tallies;
+};
@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FakeProjectileTable.h"
+#include "Projectile.h"
+
+FFakeProjectileTable::FFakeProjectileTable()
+{
+	Slots.SetNum(Capacity);
+}
+
+void FFakeProjectileTable::Add(uint16 Id, AProjectile* Projectile, double Time)
+{
+	check(Id != NULL_PROJECTILE_ID);
+	++Stats.NumAdded;
+
+	// The ID Wrapped Around onto an Entry that was never Removed
+	int32 Slot = FindSlot(Id);
+	if (Slot != INDEX_NONE)
+	{
+		++Stats.NumOverwritten;
+		Slots[Slot].Projectile = Projectile;
+		Slots[Slot].AddTime = Time;
+		return;
+	}
+
+	// Full, Make Room by Dropping the Oldest Entry
+	if (NumEntries == Capacity)
+	{
+		int32 OldestSlot = 0;
+		for (int32 i = 1; i < Capacity; ++i)
+		{
+			if (Slots[i].AddTime < Slots[OldestSlot].AddTime)
+			{
+				OldestSlot = i;
+			}
+		}
+
+		++Stats.NumOverwritten;
+		RemoveAt(OldestSlot);
+	}
+
+	Slot = Id & Mask;
+	while (Slots[Slot].Id != NULL_PROJECTILE_ID)
+	{
+		Slot = (Slot + 1) & Mask;
+	}
+
+	Slots[Slot].Id = Id;
+	Slots[Slot].Projectile = Projectile;
+	Slots[Slot].AddTime = Time;
+
+	++NumEntries;
+	Stats.PeakNum = FMath::Max(Stats.PeakNum, NumEntries);
+}
+
+AProjectile* FFakeProjectileTable::Find(uint16 Id) const
+{
+	const int32 Slot = FindSlot(Id);
+	return Slot != INDEX_NONE ? Slots[Slot].Projectile.Get() : nullptr;
+}
+
+bool FFakeProjectileTable::Remove(uint16 Id)
+{
+	const int32 Slot = FindSlot(Id);
+	if (Slot == INDEX_NONE)
+		return false;
+
+	RemoveAt(Slot);
+	return true;
+}
+
+int32 FFakeProjectileTable::ExpireOlderThan(double Time)
+{
+	// Collect First, Removing Shifts Entries around
+	TArray<uint16, TInlineAllocator<32>> ExpiredIds;
+	for (const FEntry& Entry : Slots)
+	{
+		if (Entry.Id != NULL_PROJECTILE_ID && Entry.AddTime < Time)
+		{
+			ExpiredIds.Add(Entry.Id);
+
+			// Nothing Removed this Entry when its Projectile Ended
+			const AProjectile* Projectile = Entry.Projectile.Get();
+			if (!Projectile || Projectile->GetProjectileId() != Entry.Id)
+			{
+				++Stats.NumLeaked;
+			}
+		}
+	}
+
+	for (const uint16 Id : ExpiredIds)
+	{
+		Remove(Id);
+	}
+
+	Stats.NumExpired += ExpiredIds.Num();
+	return ExpiredIds.Num();
+}
+
+int32 FFakeProjectileTable::FindSlot(uint16 Id) const
+{
+	if (Id == NULL_PROJECTILE_ID)
+		return INDEX_NONE;
+
+	int32 Slot = Id & Mask;
+	for (int32 Probe = 0; Probe < Capacity; ++Probe)
+	{
+		const uint16 SlotId = Slots[Slot].Id;
+		if (SlotId == Id)
+			return Slot;
+		if (SlotId == NULL_PROJECTILE_ID)
+			return INDEX_NONE;
+
+		Slot = (Slot + 1) & Mask;
+	}
+
+	return INDEX_NONE;
+}
+
+void FFakeProjectileTable::RemoveAt(int32 Slot)
+{
+	Slots[Slot] = FEntry();
+	--NumEntries;
+
+	// Pull Later Entries of the same Probe Run back into the Hole
+	int32 Hole = Slot;
+	int32 Next = (Slot + 1) & Mask;
+	while (Slots[Next].Id != NULL_PROJECTILE_ID)
+	{
+		const int32 Home = Slots[Next].Id & Mask;
+		if (((Next - Home) & Mask) >= ((Next - Hole) & Mask))
+		{
+			Slots[Hole] = MoveTemp(Slots[Next]);
+			Slots[Next] = FEntry();
+			Hole = Next;
+		}
+		Next = (Next + 1) & Mask;
+	}
+}
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AProjectile;
+
+struct FFakeProjectileTableStats
+{
+	int32 NumAdded = 0;
+	int32 NumExpired = 0; // Removed by Age
+	int32 NumLeaked = 0; // Expired Entries whose Fake Projectile was already Gone
+	int32 NumOverwritten = 0; // Id Wrapped onto a Live Entry, or the Table was Full
+	int32 PeakNum = 0;
+};
+
+/**
+ * Fixed-capacity, open-addressed (linear probing) table of a client's in-flight fake projectiles, keyed by their
+ * 16-bit wrapping projectile ID. Entries are removed when their projectile event arrives or the projectile is
+ * recycled, and anything older than the expiry age is dropped, so lost events can't grow it during a long match.
+ */
+struct AERIALCOMBAT_API FFakeProjectileTable
+{
+	static constexpr int32 Capacity = 256; // Power of Two, Well Above the Rounds a Player can have in Flight
+
+	FFakeProjectileTable();
+
+	void Add(uint16 Id, AProjectile* Projectile, double Time);
+
+	AProjectile* Find(uint16 Id) const;
+
+	// Returns true if there was an Entry for Id
+	bool Remove(uint16 Id);
+
+	// Drops Entries Added before Time. Returns the Number Dropped.
+	int32 ExpireOlderThan(double Time);
+
+	int32 Num() const { return NumEntries; }
+
+	const FFakeProjectileTableStats& GetStats() const { return Stats; }
+
+private:
+	struct FEntry
+	{
+		TWeakObjectPtr<AProjectile> Projectile;
+		double AddTime = 0.0;
+		uint16 Id = 0; // 0 (NULL_PROJECTILE_ID) Marks an Empty Slot
+	};
+
+	static constexpr int32 Mask = Capacity - 1;
+
+	int32 FindSlot(uint16 Id) const;
+
+	// Backward-Shift Deletion, so Probes never need Tombstones
+	void RemoveAt(int32 Slot);
+
+	TArray<FEntry> Slots;
+	int32 NumEntries = 0;
+
+	FFakeProjectileTableStats Stats;
+};
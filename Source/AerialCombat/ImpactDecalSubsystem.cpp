@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ImpactDecalSubsystem.h"
+#include "AerialCombat.h"
+#include "CombatVehicle.h"
+#include "Components/DecalComponent.h"
+#include "Camera/PlayerCameraManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Impact Decal"), STAT_SpawnImpactDecal, STATGROUP_AerialCombat);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Live Impact Decals"), STAT_LiveImpactDecals, STATGROUP_AerialCombat);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Impact Decal Components"), STAT_ImpactDecalComponents, STATGROUP_AerialCombat);
+
+bool UImpactDecalSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UImpactDecalSubsystem::Deinitialize()
+{
+	if (Stats.NumSpawned > 0 || Stats.NumCulled > 0)
+	{
+		UE_LOG(LogAerialCombat, Log, TEXT("Impact decals: %d shown (%.2fus each) with %d components, peak %d visible, %d evicted by vehicle ring, %d by budget, %d culled by distance, %d expired."),
+			Stats.NumSpawned, Stats.NumSpawned > 0 ? FPlatformTime::ToMilliseconds64(Stats.SpawnCycles) * 1000.0 / Stats.NumSpawned : 0.0,
+			Stats.NumComponentsCreated, Stats.PeakLive, Stats.NumEvictedByVehicle, Stats.NumEvictedByBudget, Stats.NumCulled, Stats.NumExpired);
+	}
+
+	LiveDecals.Empty();
+	LiveHead = 0;
+	NumLiveSlots = 0;
+	NumLiveDecals = 0;
+
+	Super::Deinitialize();
+}
+
+TStatId UImpactDecalSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UImpactDecalSubsystem, STATGROUP_Tickables);
+}
+
+void UImpactDecalSubsystem::Tick(float DeltaTime)
+{
+	SET_DWORD_STAT(STAT_LiveImpactDecals, NumLiveDecals);
+
+	// Oldest First, so only the Front can have Expired
+	const double Now = GetWorld()->GetTimeSeconds();
+	while (NumLiveSlots > 0)
+	{
+		const FLiveDecal& Oldest = LiveDecals[LiveHead];
+		if (Oldest.DecalIndex != INDEX_NONE && Oldest.ExpiryTime > Now)
+			break;
+
+		if (DropOldestDecal())
+		{
+			++Stats.NumExpired;
+		}
+	}
+}
+
+void UImpactDecalSubsystem::SpawnDecal(ACombatVehicle* Vehicle, const FVector& Location, const FRotator& Rotation, const FVector& DecalSize)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpawnImpactDecal);
+
+	UWorld* World = GetWorld();
+	if (!Vehicle || !Vehicle->DecalMaterial || World->GetNetMode() == NM_DedicatedServer)
+		return;
+
+	// Nobody would See it
+	const APlayerController* LocalPlayerCont = World->GetFirstPlayerController();
+	if (LocalPlayerCont && LocalPlayerCont->PlayerCameraManager &&
+		FVector::DistSquared(LocalPlayerCont->PlayerCameraManager->GetCameraLocation(), Location) > FMath::Square(MaxDecalDistance))
+	{
+		++Stats.NumCulled;
+		return;
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	const int32 MaxLive = FMath::Max(MaxLiveDecals, 1);
+	if (LiveDecals.IsEmpty())
+	{
+		LiveDecals.SetNum(MaxLive * 2);
+	}
+
+	const int32 DecalIndex = AcquireVehicleDecal(Vehicle);
+	UDecalComponent* Decal = Vehicle->ImpactDecals[DecalIndex];
+
+	// Reusing a Decal that's still Showing leaves a Hole where it was
+	if (Vehicle->ImpactDecalLiveSlots[DecalIndex] != INDEX_NONE)
+	{
+		HideDecal(Vehicle->ImpactDecalLiveSlots[DecalIndex]);
+		++Stats.NumEvictedByVehicle;
+	}
+
+	// Stay within the World's Budget
+	while (NumLiveDecals >= MaxLive)
+	{
+		if (DropOldestDecal())
+		{
+			++Stats.NumEvictedByBudget;
+		}
+	}
+
+	// At most MaxLive Decals are Left, so this Frees at least Half the Ring
+	if (NumLiveSlots == LiveDecals.Num())
+	{
+		CompactLiveDecals();
+	}
+
+	Decal->DecalSize = DecalSize;
+	Decal->SetWorldLocationAndRotation(Location, Rotation);
+	Decal->SetVisibility(true);
+	Decal->MarkRenderStateDirty();
+
+	const int32 Slot = (LiveHead + NumLiveSlots) % LiveDecals.Num();
+	FLiveDecal& LiveDecal = LiveDecals[Slot];
+	LiveDecal.Component = Decal;
+	LiveDecal.DecalIndex = DecalIndex;
+	LiveDecal.ExpiryTime = World->GetTimeSeconds() + DecalLifeTime;
+	Vehicle->ImpactDecalLiveSlots[DecalIndex] = Slot;
+	++NumLiveSlots;
+	++NumLiveDecals;
+
+	++Stats.NumSpawned;
+	Stats.PeakLive = FMath::Max(Stats.PeakLive, NumLiveDecals);
+	Stats.SpawnCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+void UImpactDecalSubsystem::ReleaseDecals(ACombatVehicle* Vehicle)
+{
+	// Leave Holes, the Ring Drops them as it Goes
+	for (const int32 Slot : Vehicle->ImpactDecalLiveSlots)
+	{
+		if (Slot != INDEX_NONE)
+		{
+			LiveDecals[Slot].Component.Reset();
+			LiveDecals[Slot].DecalIndex = INDEX_NONE;
+			--NumLiveDecals;
+		}
+	}
+
+	DEC_DWORD_STAT_BY(STAT_ImpactDecalComponents, Vehicle->ImpactDecals.Num());
+	Vehicle->ImpactDecals.Reset();
+	Vehicle->ImpactDecalLiveSlots.Reset();
+	Vehicle->NextImpactDecal = 0;
+}
+
+int32 UImpactDecalSubsystem::AcquireVehicleDecal(ACombatVehicle* Vehicle)
+{
+	// Ring not Full yet
+	if (Vehicle->ImpactDecals.Num() < FMath::Max(Vehicle->MaxImpactDecals, 1))
+	{
+		UDecalComponent* Decal = NewObject<UDecalComponent>(Vehicle, NAME_None, RF_Transient);
+		Decal->SetDecalMaterial(Vehicle->DecalMaterial);
+		Decal->SetFadeScreenSize(DecalFadeScreenSize);
+		Decal->SetVisibility(false);
+		Decal->SetupAttachment(Vehicle->MeshComp);
+		Decal->RegisterComponent();
+		Vehicle->ImpactDecals.Add(Decal);
+		Vehicle->ImpactDecalLiveSlots.Add(INDEX_NONE);
+
+		INC_DWORD_STAT(STAT_ImpactDecalComponents);
+		++Stats.NumComponentsCreated;
+		return Vehicle->ImpactDecals.Num() - 1;
+	}
+
+	// Oldest Decal of this Vehicle
+	const int32 DecalIndex = Vehicle->NextImpactDecal;
+	Vehicle->NextImpactDecal = (Vehicle->NextImpactDecal + 1) % Vehicle->ImpactDecals.Num();
+	return DecalIndex;
+}
+
+bool UImpactDecalSubsystem::HideDecal(int32 Slot)
+{
+	FLiveDecal& LiveDecal = LiveDecals[Slot];
+	if (LiveDecal.DecalIndex == INDEX_NONE)
+		return false;
+
+	if (UDecalComponent* Decal = LiveDecal.Component.Get())
+	{
+		Decal->SetVisibility(false);
+		if (ACombatVehicle* Vehicle = Cast<ACombatVehicle>(Decal->GetOwner()))
+		{
+			Vehicle->ImpactDecalLiveSlots[LiveDecal.DecalIndex] = INDEX_NONE;
+		}
+	}
+
+	LiveDecal.Component.Reset();
+	LiveDecal.DecalIndex = INDEX_NONE;
+	--NumLiveDecals;
+	return true;
+}
+
+bool UImpactDecalSubsystem::DropOldestDecal()
+{
+	const bool bHidden = HideDecal(LiveHead);
+	LiveHead = (LiveHead + 1) % LiveDecals.Num();
+	--NumLiveSlots;
+	return bHidden;
+}
+
+void UImpactDecalSubsystem::CompactLiveDecals()
+{
+	// Decals only Move towards the Head, so this can't Overwrite one not Moved yet
+	int32 NumKept = 0;
+	for (int32 i = 0; i < NumLiveSlots; ++i)
+	{
+		const int32 From = (LiveHead + i) % LiveDecals.Num();
+		if (LiveDecals[From].DecalIndex == INDEX_NONE)
+			continue;
+
+		const int32 To = (LiveHead + NumKept) % LiveDecals.Num();
+		if (To != From)
+		{
+			LiveDecals[To] = LiveDecals[From];
+			LiveDecals[From].Component.Reset();
+			LiveDecals[From].DecalIndex = INDEX_NONE;
+		}
+
+		UDecalComponent* Decal = LiveDecals[To].Component.Get();
+		if (ACombatVehicle* Vehicle = Decal ? Cast<ACombatVehicle>(Decal->GetOwner()) : nullptr)
+		{
+			Vehicle->ImpactDecalLiveSlots[LiveDecals[To].DecalIndex] = To;
+		}
+		++NumKept;
+	}
+	NumLiveSlots = NumKept;
+}
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ImpactDecalSubsystem.generated.h"
+
+class ACombatVehicle;
+class UDecalComponent;
+
+struct FImpactDecalStats
+{
+	int32 NumComponentsCreated = 0;
+	int32 NumSpawned = 0;
+	int32 NumEvictedByVehicle = 0; // Oldest Decal of a Full Vehicle Ring Reused
+	int32 NumEvictedByBudget = 0; // Oldest Decal in the World Hidden to Stay within Budget
+	int32 NumCulled = 0; // Too Far from the Camera to Spawn
+	int32 NumExpired = 0;
+	int32 PeakLive = 0;
+	uint64 SpawnCycles = 0;
+};
+
+/**
+ * Projectile impact decals on vehicles, without creating a decal component per hit.
+ *
+ * Each vehicle owns a small ring of decal components (ACombatVehicle::MaxImpactDecals), created on its first hits and
+ * reused oldest first. On top of that the world keeps at most MaxLiveDecals visible, hiding the oldest decal anywhere
+ * when a new one would go over. Impacts farther than MaxDecalDistance from the local camera aren't shown at all, and
+ * shown decals fade out by screen size.
+ */
+UCLASS(Config = Game)
+class AERIALCOMBAT_API UImpactDecalSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Visible impact decals in the world, across every vehicle. */
+	UPROPERTY(Config)
+	int32 MaxLiveDecals = 96;
+
+	/** Seconds a decal stays visible. */
+	UPROPERTY(Config)
+	float DecalLifeTime = 5.0f;
+
+	/** Impacts farther than this (in cm) from the local camera don't get a decal. */
+	UPROPERTY(Config)
+	float MaxDecalDistance = 15000.0f;
+
+	/** Screen size below which decals aren't drawn. */
+	UPROPERTY(Config)
+	float DecalFadeScreenSize = 0.005f;
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Shows an impact decal attached to a vehicle. Does nothing on a dedicated server. */
+	void SpawnDecal(ACombatVehicle* Vehicle, const FVector& Location, const FRotator& Rotation, const FVector& DecalSize);
+
+	/** Forgets a vehicle's decals (its components go away with it). */
+	void ReleaseDecals(ACombatVehicle* Vehicle);
+
+	int32 GetNumLiveDecals() const { return NumLiveDecals; }
+
+	const FImpactDecalStats& GetStats() const { return Stats; }
+
+private:
+	/** Takes the vehicle's next ring slot, creating its component if the ring isn't full yet. Returns its index. */
+	int32 AcquireVehicleDecal(ACombatVehicle* Vehicle);
+
+	/** Hides the decal in a live slot and leaves a hole there. Returns whether the slot held a decal. */
+	bool HideDecal(int32 Slot);
+
+	/** Pops the oldest live slot, hiding its decal. Returns whether it held one. */
+	bool DropOldestDecal();
+
+	/** Moves the live decals together to the front of the ring, dropping holes. */
+	void CompactLiveDecals();
+
+	struct FLiveDecal
+	{
+		TWeakObjectPtr<UDecalComponent> Component;
+		int32 DecalIndex = INDEX_NONE; // In the Owning Vehicle's Ring, INDEX_NONE for a Hole
+		double ExpiryTime = 0.0;
+	};
+
+	/**
+	 * Visible decals in a ring, oldest first from LiveHead (they all live for DecalLifeTime). A decal reused by its
+	 * vehicle leaves a hole behind instead of shifting the ring. The ring holds twice the budget and is compacted when
+	 * full, which only happens after at least MaxLiveDecals spawns.
+	 */
+	TArray<FLiveDecal> LiveDecals;
+	int32 LiveHead = 0;
+	int32 NumLiveSlots = 0; // Including Holes
+	int32 NumLiveDecals = 0;
+
+	FImpactDecalStats Stats;
+};
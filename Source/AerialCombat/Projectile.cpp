@@ -2,11 +2,11 @@
 
 
 #include "Projectile.h"
-#include <Net/UnrealNetwork.h>
 #include <Kismet/GameplayStatics.h>
 #include "Components/DecalComponent.h"
 
 #include "CombatVehicle.h"
+#include "ProjectilePoolSubsystem.h"
 
 // Sets default values
 AProjectile::AProjectile()
@@ -14,9 +14,11 @@ AProjectile::AProjectile()
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 	
-	bReplicates = true;
+	// Projectiles are Local Visuals, Authoritative Rounds are Simulated by UServerProjectileSubsystem
+	bReplicates = false;
 
 	ProjectileId = NULL_PROJECTILE_ID;
+	bIsFakeProjectile = false;
 
 	// Damage done to Vehicles
 	DamageType = UDamageType::StaticClass();
@@ -29,25 +31,17 @@ AProjectile::AProjectile(const FObjectInitializer& ObjectInitializer)
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
-	bReplicates = true;
+	// Projectiles are Local Visuals, Authoritative Rounds are Simulated by UServerProjectileSubsystem
+	bReplicates = false;
 
 	ProjectileId = NULL_PROJECTILE_ID;
+	bIsFakeProjectile = false;
 
 	// Damage done to Vehicles
 	DamageType = UDamageType::StaticClass();
 	Damage = 5.0f;
 }
 
-void AProjectile::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
-{
-	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-
-	constexpr bool bUsePushModel = true;
-
-	FDoRepLifetimeParams OwnerOnlyParams{ COND_OwnerOnly, REPNOTIFY_Always, bUsePushModel };
-	DOREPLIFETIME_WITH_PARAMS_FAST(AProjectile, ProjectileId, OwnerOnlyParams);
-}
-
 void AProjectile::InitFakeProjectile(AACPlayerController* OwningPlayer, uint32 InProjectileId)
 {
 	if (InProjectileId == NULL_PROJECTILE_ID)
@@ -58,7 +52,7 @@ void AProjectile::InitFakeProjectile(AACPlayerController* OwningPlayer, uint32 I
 	bIsFakeProjectile = true;
 	if (OwningPlayer)
 	{
-		OwningPlayer->FakeProjectiles.Add(InProjectileId, this);
+		OwningPlayer->RegisterFakeProjectile(InProjectileId, this);
 	}
 }
 
@@ -67,36 +61,30 @@ void AProjectile::BeginPlay()
 {
 	Super::BeginPlay();
 
-	AACPlayerController* PlayerCont = GetInstigator() ? GetInstigatorController<AACPlayerController>() : nullptr;
-	if (!PlayerCont)
-	{
-		Destroy();
-		return;
-	}
-
 	SphereCollision = FindComponentByClass<USphereComponent>();
 	StaticMesh = FindComponentByClass<UStaticMeshComponent>();
 	ProjectileMovement = FindComponentByClass<UProjectileMovementComponent>();
 
-	// Initialize the replicated authoritative projectile once it's replicated to the owning client.
-	if (!HasAuthority() && (ProjectileId != NULL_PROJECTILE_ID))
-	{
-		// Link to the associated fake projectile.
-		if (ensureAlwaysMsgf(PlayerCont->FakeProjectiles.Contains(ProjectileId), TEXT("Client-side authoritative projectile (%s) failed to find corresponding fake projectile with ID (%i)."), *GetNameSafe(this), ProjectileId))
-		{
-			LinkFakeProjectile(PlayerCont->FakeProjectiles[ProjectileId]);
-			PlayerCont->FakeProjectiles.Remove(ProjectileId);
-		}
-
-		// Don't be Visible on the Client-Side, we will only render the Fake Projectile!
-		StaticMesh->SetVisibility(false);
-	}
-
 	if (HasAuthority())
 	{
 		SphereCollision->OnComponentBeginOverlap.AddDynamic(this, &AProjectile::OnProjectileBeginOverlap);
 		SphereCollision->OnComponentHit.AddDynamic(this, &AProjectile::OnProjectileHit);
 	}
+
+	// Pre-warmed Projectiles wait in the Pool until Acquired
+	if (bIsPrewarming)
+	{
+		bIsPrewarming = false;
+		DeactivatePooled();
+		return;
+	}
+
+	// Pooled Projectiles are Visuals, and may belong to a Remote Shooter without a Controller here
+	AACPlayerController* PlayerCont = GetInstigator() ? GetInstigatorController<AACPlayerController>() : nullptr;
+	if (!PlayerCont && !bIsPooled)
+	{
+		Destroy();
+	}
 }
 
 void AProjectile::OnProjectileBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& Hit)
@@ -106,30 +94,81 @@ void AProjectile::OnProjectileBeginOverlap(UPrimitiveComponent* OverlappedCompon
 		return;
 	if (OtherActor)
 	{
-		// Apply Damage
-		UGameplayStatics::ApplyPointDamage(OtherActor, Damage, FVector(), Hit, GetInstigator()->Controller, GetInstigator(), DamageType);
-		
-		// Spawn Decal
-		if (ACombatVehicle* CV = Cast<ACombatVehicle>(OtherActor))
-		{
-			CV->RPC_Server_SpawnDecal(Hit.Location, (-Hit.ImpactNormal).Rotation(), DecalSize);
-		}
-
-		// Queue for Destroy
-		Destroy();
+		// Visual Only, Damage and Decals come from the Server's Round (UServerProjectileSubsystem)
+		ReleaseOrDestroy();
 	}
 }
 
 void AProjectile::OnProjectileHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
 	// Queue for Destroy
+	ReleaseOrDestroy();
+}
+
+void AProjectile::LifeSpanExpired()
+{
+	ReleaseOrDestroy();
+}
+
+void AProjectile::ReleaseOrDestroy()
+{
+	UProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UProjectilePoolSubsystem>();
+	if (bIsPooled && Pool)
+	{
+		Pool->ReleaseProjectile(this);
+		return;
+	}
+
 	Destroy();
 }
 
-void AProjectile::LinkFakeProjectile(AProjectile* InFakeProjectile)
+void AProjectile::ActivatePooled(const FVector& Location, const FRotator& Rotation, const FActorSpawnParameters& SpawnParams)
 {
-	LinkedFakeProjectile = InFakeProjectile;
-	InFakeProjectile->LinkedAuthProjectile = this;
+	// Same Initialization Order as SpawnActor
+	SetOwner(SpawnParams.Owner);
+	SetInstigator(SpawnParams.Instigator);
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+	if (SpawnParams.CustomPreSpawnInitalization)
+	{
+		SpawnParams.CustomPreSpawnInitalization(this);
+	}
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+	SetLifeSpan(GetDefault<AActor>(GetClass())->InitialLifeSpan);
+
+	if (ProjectileMovement)
+	{
+		ProjectileMovement->SetUpdatedComponent(GetRootComponent());
+		ProjectileMovement->Velocity = Rotation.Vector() * ProjectileMovement->InitialSpeed;
+		ProjectileMovement->Activate(true);
+	}
+}
+
+void AProjectile::DeactivatePooled()
+{
+	// A Late Projectile Event must not Reach a Recycled Fake
+	AACPlayerController* PlayerCont = GetInstigator() ? GetInstigatorController<AACPlayerController>() : nullptr;
+	if (bIsFakeProjectile && PlayerCont)
+	{
+		PlayerCont->UnregisterFakeProjectile(ProjectileId, this);
+	}
+	ProjectileId = NULL_PROJECTILE_ID;
+	bIsFakeProjectile = false;
+
+	if (ProjectileMovement)
+	{
+		ProjectileMovement->StopMovementImmediately();
+		ProjectileMovement->Deactivate();
+	}
+
+	SetLifeSpan(0.0f);
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+	SetOwner(nullptr);
+	SetInstigator(nullptr);
 }
 
 // Called every frame
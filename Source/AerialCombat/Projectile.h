@@ -19,23 +19,21 @@ class AERIALCOMBAT_API AProjectile : public AActor
 
 protected:
 
-	/** This projectile's ID. Used to link fake and authoritative projectiles. Only valid on the owning client (i.e. the
-	 * client with the fake projectile). NULL_PROJECTILE_ID on other machines. Set before BeginPlay. */
-	UPROPERTY(Replicated)
+	/** This projectile's ID. Links the fake projectile to its authoritative round, whose events (see
+	 * AACPlayerController::RPC_Client_ProjectileEvents) carry the same ID. Only valid on the owning client's fake
+	 * projectile, NULL_PROJECTILE_ID on other machines. Set before BeginPlay. */
 	uint32 ProjectileId;
 
 	/** Whether this projectile is a fake client-side projectile. Set before BeginPlay. */
 	bool bIsFakeProjectile;
 
-	/** The fake projectile that is representing this actor on the owning client, if this actor is the authoritative
-	 * server-side projectile. */
-	UPROPERTY()
-	TObjectPtr<AProjectile> LinkedFakeProjectile;
+	/** Whether this projectile is owned by the projectile pool (local visual projectiles only). Set before BeginPlay. */
+	bool bIsPooled = false;
 
-	/** The authoritative server-side projectile that is representing this actor on the server and remote clients, if
-	 * this actor is the fake client-side projectile. */
-	UPROPERTY()
-	TObjectPtr<AProjectile> LinkedAuthProjectile;
+	/** Whether this projectile is being spawned to pre-warm the pool, and should stay inactive. Set before BeginPlay. */
+	bool bIsPrewarming = false;
+
+	friend class UProjectilePoolSubsystem;
 
 public:	
 
@@ -66,6 +64,17 @@ public:
 	/** Initialize this projectile as the fake projectile. */
 	void InitFakeProjectile(AACPlayerController* OwningPlayer, uint32 InProjectileId);
 
+	FORCEINLINE uint32 GetProjectileId() const { return ProjectileId; }
+
+	/** Return this projectile to the pool if it's pooled, otherwise destroy it. */
+	void ReleaseOrDestroy();
+
+	/** Reset this pooled projectile to a freshly spawned state. */
+	void ActivatePooled(const FVector& Location, const FRotator& Rotation, const FActorSpawnParameters& SpawnParams);
+
+	/** Stop, hide and unlink this pooled projectile so it can be reused. */
+	void DeactivatePooled();
+
 	// Delegate called when SphereComponent begins Overlapping something
 	UFUNCTION(Category = "Projectile")
 	void OnProjectileBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
@@ -77,13 +86,10 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-	/** Link this authoritative projectile with its corresponding fake projectile. */
-	void LinkFakeProjectile(AProjectile* InFakeProjectile);
-
 
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
-	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void LifeSpanExpired() override;
 };
@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ProjectilePoolSubsystem.h"
+#include "AerialCombat.h"
+#include "Projectile.h"
+
+DECLARE_CYCLE_STAT(TEXT("Acquire Projectile"), STAT_AcquireProjectile, STATGROUP_AerialCombat);
+
+bool UProjectilePoolSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UProjectilePoolSubsystem::Deinitialize()
+{
+	if (Stats.NumSpawned > 0)
+	{
+		UE_LOG(LogAerialCombat, Log, TEXT("Projectile pool: %d actors spawned, %d shots reused, %d released, %d discarded."),
+			Stats.NumSpawned, Stats.NumReused, Stats.NumReleased, Stats.NumDiscarded);
+	}
+
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UProjectilePoolSubsystem::CanPoolProjectiles(const UWorld* World)
+{
+	// Pooled Projectiles are Local Visuals, a Dedicated Server doesn't Render any
+	return World && World->GetNetMode() != NM_DedicatedServer;
+}
+
+AProjectile* UProjectilePoolSubsystem::AcquireProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, const FActorSpawnParameters& SpawnParams)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AcquireProjectile);
+
+	FProjectilePool* Pool = Pools.Find(ProjectileClass);
+	if (!Pool)
+	{
+		Pool = &Pools.Add(ProjectileClass);
+		PrewarmPool(ProjectileClass, *Pool);
+	}
+
+	// Reuse an Inactive Projectile
+	while (Pool->InactiveProjectiles.Num() > 0)
+	{
+		AProjectile* Projectile = Pool->InactiveProjectiles.Pop(EAllowShrinking::No);
+		if (!IsValid(Projectile))
+			continue;
+
+		Projectile->ActivatePooled(Location, Rotation, SpawnParams);
+		++Stats.NumReused;
+		return Projectile;
+	}
+
+	// Pool ran Dry, Grow it
+	return SpawnPooledProjectile(ProjectileClass, Location, Rotation, SpawnParams);
+}
+
+void UProjectilePoolSubsystem::ReleaseProjectile(AProjectile* Projectile)
+{
+	if (!IsValid(Projectile))
+		return;
+
+	++Stats.NumReleased;
+
+	FProjectilePool& Pool = Pools.FindOrAdd(Projectile->GetClass());
+	if (Pool.InactiveProjectiles.Num() >= MaxPooledPerClass)
+	{
+		++Stats.NumDiscarded;
+		Projectile->bIsPooled = false;
+		Projectile->Destroy();
+		return;
+	}
+
+	Projectile->DeactivatePooled();
+	Pool.InactiveProjectiles.Add(Projectile);
+}
+
+void UProjectilePoolSubsystem::PrewarmPool(TSubclassOf<AProjectile> ProjectileClass, FProjectilePool& Pool)
+{
+	Pool.InactiveProjectiles.Reserve(MaxPooledPerClass);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.CustomPreSpawnInitalization = [](AActor* Actor)
+	{
+		// Stay Inactive after BeginPlay
+		if (AProjectile* Projectile = Cast<AProjectile>(Actor))
+		{
+			Projectile->bIsPooled = true;
+			Projectile->bIsPrewarming = true;
+			Projectile->SetReplicates(false);
+		}
+	};
+
+	for (int32 i = 0; i < PrewarmCount; ++i)
+	{
+		if (AProjectile* Projectile = GetWorld()->SpawnActor<AProjectile>(ProjectileClass, FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams))
+		{
+			++Stats.NumSpawned;
+			Pool.InactiveProjectiles.Add(Projectile);
+		}
+	}
+}
+
+AProjectile* UProjectilePoolSubsystem::SpawnPooledProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, const FActorSpawnParameters& SpawnParams)
+{
+	FActorSpawnParameters PooledSpawnParams = SpawnParams;
+	PooledSpawnParams.CustomPreSpawnInitalization = [CustomInit = SpawnParams.CustomPreSpawnInitalization](AActor* Actor)
+	{
+		if (AProjectile* Projectile = Cast<AProjectile>(Actor))
+		{
+			Projectile->bIsPooled = true;
+			Projectile->SetReplicates(false);
+		}
+		if (CustomInit)
+		{
+			CustomInit(Actor);
+		}
+	};
+
+	AProjectile* Projectile = GetWorld()->SpawnActor<AProjectile>(ProjectileClass, Location, Rotation, PooledSpawnParams);
+	if (!IsValid(Projectile))
+		return nullptr;
+
+	++Stats.NumSpawned;
+	return Projectile;
+}
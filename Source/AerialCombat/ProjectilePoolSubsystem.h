@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ProjectilePoolSubsystem.generated.h"
+
+class AProjectile;
+
+USTRUCT()
+struct FProjectilePool
+{
+	GENERATED_BODY()
+
+	/** Hidden, inactive projectiles ready to be reused. */
+	UPROPERTY()
+	TArray<TObjectPtr<AProjectile>> InactiveProjectiles;
+};
+
+struct FProjectilePoolStats
+{
+	int32 NumSpawned = 0; // Actors Created (Including Pre-warming)
+	int32 NumReused = 0; // Shots Served from the Pool
+	int32 NumReleased = 0;
+	int32 NumDiscarded = 0; // Destroyed because the Pool was Full
+};
+
+/**
+ * Per-world pool of client-local projectiles. Fake (predicted) projectiles are acquired from here instead of being
+ * spawned, and returned instead of being destroyed, so continuous fire doesn't churn actor allocation, component
+ * registration and garbage collection.
+ *
+ * Pooled projectiles never replicate. They are only visuals: authoritative rounds are simulated by
+ * UServerProjectileSubsystem, so a dedicated server doesn't pool (or spawn) projectile actors at all.
+ */
+UCLASS(Config = Game)
+class AERIALCOMBAT_API UProjectilePoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Instances spawned for a class the first time it's requested. */
+	UPROPERTY(Config)
+	int32 PrewarmCount = 16;
+
+	/** Inactive instances kept per class. Anything released beyond this is destroyed. */
+	UPROPERTY(Config)
+	int32 MaxPooledPerClass = 128;
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	/** Whether this world renders projectiles (i.e. isn't a dedicated server), and so can pool them. */
+	static bool CanPoolProjectiles(const UWorld* World);
+
+	/** Takes a projectile from the pool (spawning one if the pool is empty) and initializes it like SpawnActor would,
+	 * including SpawnParams.CustomPreSpawnInitalization. Returns nullptr if the projectile couldn't be spawned. */
+	AProjectile* AcquireProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, const FActorSpawnParameters& SpawnParams);
+
+	/** Returns a projectile to the pool. */
+	void ReleaseProjectile(AProjectile* Projectile);
+
+	const FProjectilePoolStats& GetStats() const { return Stats; }
+
+private:
+	void PrewarmPool(TSubclassOf<AProjectile> ProjectileClass, FProjectilePool& Pool);
+	AProjectile* SpawnPooledProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, const FActorSpawnParameters& SpawnParams);
+
+	UPROPERTY()
+	TMap<TSubclassOf<AProjectile>, FProjectilePool> Pools;
+
+	FProjectilePoolStats Stats;
+};
@@ -0,0 +1,433 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ServerProjectileSubsystem.h"
+#include "AerialCombat.h"
+#include "Projectile.h"
+#include "CombatVehicle.h"
+#include "EngineUtils.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "Engine/SCS_Node.h"
+
+DECLARE_CYCLE_STAT(TEXT("Server Projectiles Tick"), STAT_ServerProjectilesTick, STATGROUP_AerialCombat);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Server Rounds"), STAT_ActiveServerRounds, STATGROUP_AerialCombat);
+DECLARE_CYCLE_STAT(TEXT("Resolve Damage"), STAT_ResolveDamage, STATGROUP_AerialCombat);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Queued Hits"), STAT_QueuedHits, STATGROUP_AerialCombat);
+
+namespace
+{
+	// Blueprint Components aren't on the CDO, they are Templates in the Construction Script
+	template<class T>
+	const T* FindDefaultComponent(const UClass* ActorClass)
+	{
+		if (const T* Component = GetDefault<AActor>(ActorClass)->FindComponentByClass<T>())
+		{
+			return Component;
+		}
+
+		for (const UClass* Class = ActorClass; Class; Class = Class->GetSuperClass())
+		{
+			const UBlueprintGeneratedClass* BPClass = Cast<UBlueprintGeneratedClass>(Class);
+			if (!BPClass || !BPClass->SimpleConstructionScript)
+				continue;
+
+			for (const USCS_Node* Node : BPClass->SimpleConstructionScript->GetAllNodes())
+			{
+				if (const T* Component = Cast<T>(Node->ComponentTemplate))
+				{
+					return Component;
+				}
+			}
+		}
+
+		return nullptr;
+	}
+}
+
+bool UServerProjectileSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UServerProjectileSubsystem::Deinitialize()
+{
+	if (Stats.NumFired > 0)
+	{
+		UE_LOG(LogAerialCombat, Log, TEXT("Server projectiles: %d fired, %d vehicle hits, %d world hits, %d expired, peak %d rounds in flight."),
+			Stats.NumFired, Stats.NumVehicleHits, Stats.NumWorldHits, Stats.NumExpired, Stats.PeakActiveRounds);
+	}
+	if (Stats.NumDamageFrames > 0)
+	{
+		const double ResolveDamageUs = FPlatformTime::ToMilliseconds64(Stats.ResolveDamageCycles) * 1000.0;
+		UE_LOG(LogAerialCombat, Log, TEXT("Server damage: %d hits resolved as %d damage effects over %d frames (%.2fus per frame, %.2fus per hit), %d kills."),
+			Stats.NumVehicleHits, Stats.NumDamagedTargets, Stats.NumDamageFrames, ResolveDamageUs / Stats.NumDamageFrames,
+			Stats.NumVehicleHits > 0 ? ResolveDamageUs / Stats.NumVehicleHits : 0.0, Stats.NumKills);
+	}
+
+	Super::Deinitialize();
+}
+
+TStatId UServerProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UServerProjectileSubsystem, STATGROUP_Tickables);
+}
+
+void UServerProjectileSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ServerProjectilesTick);
+	SET_DWORD_STAT(STAT_ActiveServerRounds, Positions.Num());
+
+	if (Positions.Num() > 0)
+	{
+		GatherVehicles();
+		StepRounds(0, Positions.Num(), DeltaTime);
+	}
+
+	ResolveDamage();
+	FlushEvents();
+}
+
+FVector UServerProjectileSubsystem::GetLaunchVelocity(TSubclassOf<AProjectile> ProjectileClass, const FRotator& Rotation)
+{
+	const int32 ClassIndex = FindOrAddClassInfo(ProjectileClass);
+	return ClassIndex != INDEX_NONE ? Rotation.Vector() * ClassInfos[ClassIndex].InitialSpeed : FVector::ZeroVector;
+}
+
+void UServerProjectileSubsystem::FireProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& Location, const FVector& Velocity, ACombatVehicle* Shooter,
+	uint32 ProjectileId, float ForwardPredictionTime)
+{
+	const int32 ClassIndex = FindOrAddClassInfo(ProjectileClass);
+	if (ClassIndex == INDEX_NONE || !Shooter)
+		return;
+
+	const FServerProjectileClassInfo& ClassInfo = ClassInfos[ClassIndex];
+
+	Positions.Add(Location);
+	Velocities.Add(Velocity);
+	GravityAccels.Add(GetWorld()->GetGravityZ() * ClassInfo.GravityScale);
+	TimeToLive.Add(ClassInfo.LifeSpan);
+	ProjectileIds.Add(ProjectileId);
+	ClassIndices.Add(static_cast<uint8>(ClassIndex));
+	Shooters.Add(Shooter);
+	RejectCounted.Add(false);
+
+	++Stats.NumFired;
+	Stats.PeakActiveRounds = FMath::Max(Stats.PeakActiveRounds, Positions.Num());
+
+	QueueEvent(Positions.Num() - 1, EProjectileEventType::Spawned);
+
+	// Catch up with where the Client's Fake Projectile is
+	if (ForwardPredictionTime > 0.0f)
+	{
+		GatherVehicles();
+		StepRounds(Positions.Num() - 1, Positions.Num(), ForwardPredictionTime);
+	}
+}
+
+int32 UServerProjectileSubsystem::FindOrAddClassInfo(TSubclassOf<AProjectile> ProjectileClass)
+{
+	if (!ProjectileClass)
+		return INDEX_NONE;
+
+	const int32 ExistingIndex = ClassInfos.IndexOfByPredicate([ProjectileClass](const FServerProjectileClassInfo& Info) { return Info.ProjectileClass == ProjectileClass; });
+	if (ExistingIndex != INDEX_NONE)
+		return ExistingIndex;
+
+	// Round Indices are Stored in a Byte
+	if (!ensureAlwaysMsgf(ClassInfos.Num() <= MAX_uint8, TEXT("Too many projectile classes for the server projectile manager.")))
+		return INDEX_NONE;
+
+	const AProjectile* ProjectileCDO = GetDefault<AProjectile>(ProjectileClass);
+
+	FServerProjectileClassInfo Info;
+	Info.ProjectileClass = ProjectileClass;
+	Info.Damage = ProjectileCDO->Damage;
+	Info.DecalSize = ProjectileCDO->DecalSize;
+	Info.LifeSpan = ProjectileCDO->InitialLifeSpan > 0.0f ? ProjectileCDO->InitialLifeSpan : 5.0f;
+
+	if (const UProjectileMovementComponent* Movement = FindDefaultComponent<UProjectileMovementComponent>(ProjectileClass))
+	{
+		Info.InitialSpeed = Movement->InitialSpeed > 0.0f ? Movement->InitialSpeed : Movement->Velocity.Size();
+		Info.MaxSpeed = Movement->MaxSpeed;
+		Info.GravityScale = Movement->ProjectileGravityScale;
+	}
+	if (const USphereComponent* Sphere = FindDefaultComponent<USphereComponent>(ProjectileClass))
+	{
+		Info.Radius = Sphere->GetUnscaledSphereRadius() * Sphere->GetRelativeScale3D().GetMax();
+	}
+
+	return ClassInfos.Add(Info);
+}
+
+void UServerProjectileSubsystem::StepRounds(int32 First, int32 Last, float DeltaTime)
+{
+	SweepStarts.SetNumUninitialized(Positions.Num(), EAllowShrinking::No);
+
+	// Integrate every Round in one Pass (Semi-Implicit Euler, same as UProjectileMovementComponent)
+	for (int32 i = First; i < Last; ++i)
+	{
+		SweepStarts[i] = Positions[i];
+		Velocities[i].Z += GravityAccels[i] * DeltaTime;
+		Positions[i] += Velocities[i] * DeltaTime;
+		TimeToLive[i] -= DeltaTime;
+	}
+
+	// Speed Limits are Rare, Keep them out of the Hot Loop
+	for (int32 i = First; i < Last; ++i)
+	{
+		const float MaxSpeed = ClassInfos[ClassIndices[i]].MaxSpeed;
+		if (MaxSpeed > 0.0f && Velocities[i].SizeSquared() > FMath::Square(MaxSpeed))
+		{
+			Velocities[i] = Velocities[i].GetSafeNormal() * MaxSpeed;
+		}
+	}
+
+	// Resolve Hits
+	FinishedRounds.Reset();
+	for (int32 i = First; i < Last; ++i)
+	{
+		if (SweepRound(i, SweepStarts[i]))
+		{
+			FinishedRounds.Add(i);
+		}
+		else if (TimeToLive[i] <= 0.0f || !Shooters[i].IsValid())
+		{
+			++Stats.NumExpired;
+			QueueEvent(i, EProjectileEventType::Destroyed);
+			FinishedRounds.Add(i);
+		}
+	}
+
+	// Remove from the Back so Swapped-in Rounds keep their Indices Valid
+	for (int32 i = FinishedRounds.Num() - 1; i >= 0; --i)
+	{
+		RemoveRound(FinishedRounds[i]);
+	}
+}
+
+bool UServerProjectileSubsystem::SweepRound(int32 Index, const FVector& Start)
+{
+	ACombatVehicle* Shooter = Shooters[Index].Get();
+	if (!Shooter)
+		return false;
+
+	const FServerProjectileClassInfo& ClassInfo = ClassInfos[ClassIndices[Index]];
+	const FVector& End = Positions[Index];
+	const FCollisionShape Sphere = FCollisionShape::MakeSphere(ClassInfo.Radius);
+
+	// City (Buildings and Terrain)
+	FHitResult WorldHit;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ServerProjectileSweep), false, Shooter);
+	const bool bWorldHit = GetWorld()->SweepSingleByObjectType(WorldHit, Start, End, FQuat::Identity, FCollisionObjectQueryParams(ECC_WorldStatic), Sphere, QueryParams);
+	float ClosestHitTime = bWorldHit ? WorldHit.Time : 1.0f;
+
+	// Vehicles, Rewound to what the Shooter saw
+	AACPlayerController* PlayerCont = Shooter->GetController<AACPlayerController>();
+	ACombatVehicle* HitVehicle = nullptr;
+	FHitResult VehicleHit;
+	float HitRewindTime = 0.0f;
+	bool bTouchedCurrentPoseOnly = false;
+	for (ACombatVehicle* Target : Vehicles)
+	{
+		UPrimitiveComponent* TargetComp = Cast<UPrimitiveComponent>(Target->GetRootComponent());
+		if (Target == Shooter || !TargetComp)
+			continue;
+
+		const float RewindTime = PlayerCont ? PlayerCont->GetHitRewindTime(Target->GetInterpolationDelay()) : 0.0f;
+		const float Tolerance = PlayerCont ? PlayerCont->HitValidationTolerance : 0.0f;
+
+		// Cheap Reject: the Target can't have been within Reach of this Segment
+		const float Reach = TargetComp->Bounds.SphereRadius + ClassInfo.Radius + Tolerance + Target->GetVelocity().Size() * RewindTime;
+		if (FMath::PointDistToSegmentSquared(Target->GetActorLocation(), Start, End) > FMath::Square(Reach))
+			continue;
+
+		// Move the Segment into the Target's Rewound Frame, and Sweep that against the Target's Current Collision
+		FVector RewoundStart = Start;
+		FVector RewoundEnd = End;
+		FTransform RewoundTransform;
+		if (RewindTime > 0.0f && Target->GetRewoundTransform(GetWorld()->GetTimeSeconds() - RewindTime, RewoundTransform))
+		{
+			const FTransform& CurrentTransform = Target->GetActorTransform();
+			RewoundStart = CurrentTransform.TransformPosition(RewoundTransform.InverseTransformPosition(Start));
+			RewoundEnd = CurrentTransform.TransformPosition(RewoundTransform.InverseTransformPosition(End));
+		}
+
+		FHitResult Hit;
+		const bool bAccepted = TargetComp->SweepComponent(Hit, RewoundStart, RewoundEnd, FQuat::Identity, FCollisionShape::MakeSphere(ClassInfo.Radius + Tolerance));
+		if (bAccepted && Hit.Time < ClosestHitTime)
+		{
+			ClosestHitTime = Hit.Time;
+			HitVehicle = Target;
+			VehicleHit = Hit;
+			HitRewindTime = RewindTime;
+		}
+		else if (!bAccepted && PlayerCont && RewindTime > 0.0f && !RejectCounted[Index] && !bTouchedCurrentPoseOnly)
+		{
+			// Would have Hit without the Rewind (only Swept for the Stats, and only until the Round has been Counted)
+			FHitResult PresentHit;
+			bTouchedCurrentPoseOnly = TargetComp->SweepComponent(PresentHit, Start, End, FQuat::Identity, Sphere);
+		}
+	}
+
+	// Lag Compensation Stats, once per Round: its Hit, or the First Frame it only Touched a Current Pose
+	if (PlayerCont && (HitVehicle ? HitRewindTime > 0.0f : bTouchedCurrentPoseOnly))
+	{
+		FLagCompensationStats& LagStats = PlayerCont->LagCompensationStats;
+		if (HitVehicle)
+		{
+			// A Round that only Touched a Current Pose Earlier Hit after all
+			LagStats.NumHitsRejected -= RejectCounted[Index] ? 1 : 0;
+			++LagStats.NumHitsAccepted;
+			LagStats.TotalRewindDepth += HitRewindTime;
+			LagStats.MaxRewindDepth = FMath::Max(LagStats.MaxRewindDepth, HitRewindTime);
+		}
+		else
+		{
+			++LagStats.NumHitsRejected;
+			RejectCounted[Index] = true;
+		}
+	}
+
+	if (HitVehicle)
+	{
+		++Stats.NumVehicleHits;
+
+		FQueuedDamage& Damage = QueuedDamage.AddDefaulted_GetRef();
+		Damage.Target = HitVehicle;
+		Damage.Shooter = Shooter;
+		Damage.Damage = ClassInfo.Damage;
+		QueueImpact(HitVehicle, VehicleHit, ClassInfo.DecalSize);
+		QueueEvent(Index, EProjectileEventType::Impacted, VehicleHit.Location);
+		return true;
+	}
+
+	if (bWorldHit)
+	{
+		++Stats.NumWorldHits;
+		QueueEvent(Index, EProjectileEventType::Impacted, WorldHit.Location);
+		return true;
+	}
+
+	return false;
+}
+
+void UServerProjectileSubsystem::GatherVehicles()
+{
+	Vehicles.Reset();
+	for (TActorIterator<ACombatVehicle> It(GetWorld()); It; ++It)
+	{
+		Vehicles.Add(*It);
+	}
+}
+
+void UServerProjectileSubsystem::RemoveRound(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Velocities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	GravityAccels.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	TimeToLive.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	ProjectileIds.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	ClassIndices.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Shooters.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	RejectCounted.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+void UServerProjectileSubsystem::QueueEvent(int32 Index, EProjectileEventType Type, const FVector& Location)
+{
+	const ACombatVehicle* Shooter = Shooters[Index].Get();
+	AACPlayerController* PlayerCont = Shooter ? Shooter->GetController<AACPlayerController>() : nullptr;
+	if (!PlayerCont || ProjectileIds[Index] == NULL_PROJECTILE_ID)
+		return;
+
+	PlayerCont->QueueProjectileEvent(ProjectileIds[Index], Type, Location);
+	EventControllers.AddUnique(PlayerCont);
+}
+
+void UServerProjectileSubsystem::RejectProjectile(AACPlayerController* PlayerCont, uint32 ProjectileId)
+{
+	if (!PlayerCont || ProjectileId == NULL_PROJECTILE_ID)
+		return;
+
+	// Sent with this Frame's other Events
+	PlayerCont->QueueProjectileEvent(ProjectileId, EProjectileEventType::Rejected);
+	EventControllers.AddUnique(PlayerCont);
+}
+
+void UServerProjectileSubsystem::ResolveDamage()
+{
+	SET_DWORD_STAT(STAT_QueuedHits, QueuedDamage.Num());
+	if (QueuedDamage.Num() == 0)
+		return;
+
+	SCOPE_CYCLE_COUNTER(STAT_ResolveDamage);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	// Each Target's Hits in Arrival Order: Total Damage, and whose Hit Took the Last of its Health
+	for (const FQueuedDamage& Damage : QueuedDamage)
+	{
+		if (ACombatVehicle* Target = Damage.Target.Get())
+		{
+			DamageTally.AddHit(Target, Damage.Shooter.Get(), Damage.Damage, [Target]() { return Target->GetCurrentHealth(); });
+		}
+	}
+
+	for (const TDamageTally<ACombatVehicle>::FTargetTally& Tally : DamageTally.GetTallies())
+	{
+		if (Tally.Target->ApplyQueuedDamage(Tally.TotalDamage, Tally.LastShooter))
+		{
+			++Stats.NumKills;
+		}
+		++Stats.NumDamagedTargets;
+	}
+
+	DamageTally.Reset();
+	QueuedDamage.Reset();
+
+	++Stats.NumDamageFrames;
+	Stats.ResolveDamageCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+void UServerProjectileSubsystem::QueueImpact(ACombatVehicle* Vehicle, const FHitResult& Hit, const FVector& DecalSize)
+{
+	// Hits are Swept against the Vehicle's Current Collision
+	const FTransform& VehicleTransform = Vehicle->GetActorTransform();
+	FImpactEvent Event;
+	Event.Vehicle = Vehicle;
+	Event.LocalLocation = VehicleTransform.InverseTransformPosition(Hit.Location);
+	Event.LocalNormal = VehicleTransform.InverseTransformVectorNoScale(Hit.ImpactNormal);
+	Event.DecalSize = DecalSize;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		AACPlayerController* PlayerCont = Cast<AACPlayerController>(It->Get());
+		if (!PlayerCont)
+			continue;
+
+		if (!PlayerCont->ShouldReceiveImpact(Hit.Location))
+		{
+			++PlayerCont->ImpactEventStats.NumCulled;
+			continue;
+		}
+
+		PlayerCont->QueueImpactEvent(Event);
+		if (!PlayerCont->IsLocalController())
+		{
+			EventControllers.AddUnique(PlayerCont);
+		}
+	}
+}
+
+void UServerProjectileSubsystem::FlushEvents()
+{
+	for (const TWeakObjectPtr<AACPlayerController>& PlayerCont : EventControllers)
+	{
+		if (PlayerCont.IsValid())
+		{
+			PlayerCont->FlushProjectileEvents();
+			PlayerCont->FlushImpactEvents();
+		}
+	}
+	EventControllers.Reset();
+}
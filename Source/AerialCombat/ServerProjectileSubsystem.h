@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ACPlayerController.h"
+#include "DamageTally.h"
+#include "ServerProjectileSubsystem.generated.h"
+
+class AProjectile;
+class ACombatVehicle;
+
+/** Ballistics and damage of a projectile class, read once from its defaults. */
+USTRUCT()
+struct FServerProjectileClassInfo
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSubclassOf<AProjectile> ProjectileClass;
+
+	float Damage = 0.0f;
+	FVector DecalSize = FVector(10.0f);
+	float Radius = 0.0f;
+	float InitialSpeed = 0.0f;
+	float MaxSpeed = 0.0f; // 0 means no Limit
+	float GravityScale = 0.0f;
+	float LifeSpan = 0.0f;
+};
+
+struct FServerProjectileStats
+{
+	int32 NumFired = 0;
+	int32 NumVehicleHits = 0;
+	int32 NumWorldHits = 0;
+	int32 NumExpired = 0;
+	int32 PeakActiveRounds = 0;
+	int32 NumDamageFrames = 0; // Frames with Hits to Resolve
+	int32 NumDamagedTargets = 0; // Damage Effects Applied (one per Target per Frame)
+	int32 NumKills = 0;
+	uint64 ResolveDamageCycles = 0;
+};
+
+/** A vehicle hit waiting for the end of the frame. */
+struct FQueuedDamage
+{
+	TWeakObjectPtr<ACombatVehicle> Target;
+	TWeakObjectPtr<ACombatVehicle> Shooter;
+	float Damage = 0.0f;
+};
+
+/**
+ * Server-side simulation of every authoritative round. Rounds are plain data in a structure-of-arrays buffer instead
+ * of replicated AProjectile actors. They are all advanced in one pass over contiguous arrays each frame, then swept
+ * against the city and against target vehicles rewound to what the shooter saw (lag compensation).
+ *
+ * Clients keep rendering their own projectiles: the owner its fake projectile, everyone else a visual spawned by
+ * ACombatVehicle::RPC_Multicast_SpawnProjectileVisual. The owner learns what happened to its rounds through projectile
+ * events keyed by ProjectileId (see AACPlayerController::QueueProjectileEvent), batched once per frame.
+ *
+ * Damage is queued as well, and resolved per target once per frame (see ACombatVehicle::ApplyQueuedDamage), so a
+ * vehicle hit by many rounds gets one damage gameplay effect, and its health attribute replicates once.
+ */
+UCLASS()
+class AERIALCOMBAT_API UServerProjectileSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Muzzle velocity of a projectile class fired with the given rotation (without the shooter's velocity). */
+	FVector GetLaunchVelocity(TSubclassOf<AProjectile> ProjectileClass, const FRotator& Rotation);
+
+	/** Adds an authoritative round, fast-forwarded by ForwardPredictionTime (hits included). Server only. */
+	void FireProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& Location, const FVector& Velocity, ACombatVehicle* Shooter,
+		uint32 ProjectileId, float ForwardPredictionTime);
+
+	/** Tells a client that the server refused one of its shots, so its fake projectile is removed. Server only. */
+	void RejectProjectile(AACPlayerController* PlayerCont, uint32 ProjectileId);
+
+	int32 GetNumActiveRounds() const { return Positions.Num(); }
+
+	const FServerProjectileStats& GetStats() const { return Stats; }
+
+private:
+	int32 FindOrAddClassInfo(TSubclassOf<AProjectile> ProjectileClass);
+
+	/** Advances Rounds [First, Last) and resolves their hits. Finished rounds are removed afterwards. */
+	void StepRounds(int32 First, int32 Last, float DeltaTime);
+
+	/** Sweeps one round from Start to its current position. Returns true if it hit something. */
+	bool SweepRound(int32 Index, const FVector& Start);
+
+	void GatherVehicles();
+	void RemoveRound(int32 Index);
+
+	/** Tells the shooter of a round what happened to it. */
+	void QueueEvent(int32 Index, EProjectileEventType Type, const FVector& Location = FVector::ZeroVector);
+	void FlushEvents();
+
+	/** Applies every hit queued this frame, in one health write per target (kills and leaderboard included). */
+	void ResolveDamage();
+
+	/** Tells every player near enough to see it about a hit on a vehicle. */
+	void QueueImpact(ACombatVehicle* Vehicle, const FHitResult& Hit, const FVector& DecalSize);
+
+	UPROPERTY()
+	TArray<FServerProjectileClassInfo> ClassInfos;
+
+	// Rounds (Structure of Arrays, same Index in every Array)
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<float> GravityAccels; // Gravity Z times the Class' Gravity Scale
+	TArray<float> TimeToLive;
+	TArray<uint32> ProjectileIds;
+	TArray<uint8> ClassIndices;
+	TArray<TWeakObjectPtr<ACombatVehicle>> Shooters;
+	TArray<bool> RejectCounted; // Lag Compensation Stats already have this Round as Rejected
+
+	// Scratch
+	TArray<FVector> SweepStarts;
+	TArray<int32> FinishedRounds;
+	TArray<ACombatVehicle*> Vehicles;
+
+	// Vehicle Hits this Frame, Resolved at the End of Tick
+	TArray<FQueuedDamage> QueuedDamage;
+	TDamageTally<ACombatVehicle> DamageTally;
+
+	// Shooters with Queued Projectile Events
+	TArray<TWeakObjectPtr<AACPlayerController>> EventControllers;
+
+	FServerProjectileStats Stats;
+};
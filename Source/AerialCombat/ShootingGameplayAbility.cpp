@@ -2,6 +2,7 @@
 
 
 #include "ShootingGameplayAbility.h"
+#include "CombatVehicle.h"
 
 UShootingGameplayAbility::UShootingGameplayAbility()
 {
@@ -16,16 +17,39 @@ UShootingGameplayAbility::UShootingGameplayAbility()
 void UShootingGameplayAbility::ActivateAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo, const FGameplayEventData* TriggerEventData)
 {
 	Super::ActivateAbility(Handle, ActorInfo, ActivationInfo, TriggerEventData);
-	
-	AController* Cont = Cast<APawn>(GetAvatarActorFromActorInfo())->GetController();
+
+	if (ActorInfo->IsNetAuthority())
+	{
+		if (AACPlayerController* PlayerCont = Cast<AACPlayerController>(ActorInfo->PlayerController.Get()))
+		{
+			++PlayerCont->ShootingStats.NumActivations;
+		}
+	}
+
+	// Sustained Fire: this Activation Fires until the Input is Released
+	const ACombatVehicle* Vehicle = Cast<ACombatVehicle>(GetAvatarActorFromActorInfo());
+	if (Vehicle && Vehicle->bUseSustainedFire)
+	{
+		UAbilityTask_FireBurst* BurstTask = UAbilityTask_FireBurst::FireBurst(this, ProjectileClass, Vehicle->FireRate);
+		if (BurstTask)
+		{
+			BurstTask->Finished.AddDynamic(this, &UShootingGameplayAbility::StopSustainedFire);
+			BurstTask->ReadyForActivation();
+		}
+		else
+		{
+			StopSustainedFire();
+		}
+		return;
+	}
 
 	FVector SpawnPoint = FVector();
 	FRotator SpawnRotation = FRotator();
-	
-	Cont->GetPlayerViewPoint(SpawnPoint, SpawnRotation);
-	
-	FVector Up = FRotationMatrix(SpawnRotation).GetUnitAxis(EAxis::Z);
-	SpawnPoint = SpawnPoint - Up * 15.0f;
+	if (!GetProjectileSpawnTransform(Cast<APawn>(GetAvatarActorFromActorInfo()), SpawnPoint, SpawnRotation))
+	{
+		FailedShootingAbility(nullptr);
+		return;
+	}
 	
 	UAbilityTask_SpawnPredProjectile* Task = UAbilityTask_SpawnPredProjectile::SpawnPredProjectile(this, ProjectileClass, SpawnPoint, SpawnRotation);
 	if (Task)
@@ -46,3 +70,21 @@ void UShootingGameplayAbility::FailedShootingAbility(AProjectile* SpawnedProject
 {
 	EndAbility(CurrentSpecHandle, CurrentActorInfo, CurrentActivationInfo, true, false);
 }
+
+void UShootingGameplayAbility::StopSustainedFire()
+{
+	EndAbility(CurrentSpecHandle, CurrentActorInfo, CurrentActivationInfo, true, false);
+}
+
+bool UShootingGameplayAbility::GetProjectileSpawnTransform(const APawn* Avatar, FVector& OutLocation, FRotator& OutRotation)
+{
+	AController* Cont = Avatar ? Avatar->GetController() : nullptr;
+	if (!Cont)
+		return false;
+
+	Cont->GetPlayerViewPoint(OutLocation, OutRotation);
+
+	FVector Up = FRotationMatrix(OutRotation).GetUnitAxis(EAxis::Z);
+	OutLocation = OutLocation - Up * 15.0f;
+	return true;
+}
@@ -9,6 +9,7 @@
 
 #include "Projectile.h"
 #include "AbilityTask_SpawnPredProjectile.h"
+#include "AbilityTask_FireBurst.h"
 
 #include "ShootingGameplayAbility.generated.h"
 
@@ -47,4 +48,10 @@ public:
 
     UFUNCTION()
     void FailedShootingAbility(AProjectile* SpawnedProjectile);
+
+    UFUNCTION()
+    void StopSustainedFire();
+
+    /** Where a projectile fired by Avatar spawns: just below its controller's view point, facing the view direction. */
+    static bool GetProjectileSpawnTransform(const APawn* Avatar, FVector& OutLocation, FRotator& OutRotation);
 };
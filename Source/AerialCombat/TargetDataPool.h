@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Abilities/GameplayAbilityTargetTypes.h"
+
+/**
+ * Recycles target data instances (and the handle that carries them) so sending target data every shot doesn't
+ * allocate. An instance is reused once nothing but the pool references it: the client's send serializes it right
+ * away, and a server-side cache keeps its own reference until the data is consumed. Game thread only.
+ *
+ * Owned by the sending UCVAbilitySystemComponent, never static: instances must not outlive or cross worlds.
+ */
+template<typename TargetDataType, int32 MaxPooled = 8>
+class TTargetDataPool
+{
+public:
+	/** Returns a handle holding a target data instance nobody else references. Fill it in, then send the handle. The
+	 * instance keeps whatever values it was last sent with. */
+	FGameplayAbilityTargetDataHandle& Acquire(TargetDataType*& OutTargetData)
+	{
+		// Drop the Handle's Reference from the Last Send first
+		Handle.Data.Reset();
+		++NumAcquired;
+
+		TSharedPtr<TargetDataType> TargetData;
+		for (const TSharedPtr<TargetDataType>& Entry : Entries)
+		{
+			if (Entry.GetSharedReferenceCount() == 1)
+			{
+				TargetData = Entry;
+				break;
+			}
+		}
+
+		// All Instances are still Referenced (or it's the First Send), Grow
+		if (!TargetData.IsValid())
+		{
+			TargetData = MakeShared<TargetDataType>();
+			++NumAllocations;
+			if (Entries.Num() < MaxPooled)
+			{
+				Entries.Add(TargetData);
+			}
+		}
+
+		Handle.Data.Add(TargetData);
+		OutTargetData = TargetData.Get();
+		return Handle;
+	}
+
+	/** Instances allocated so far. Stops growing once the pool is warm. */
+	int32 GetNumAllocations() const { return NumAllocations; }
+
+	/** Handles handed out so far. */
+	int32 GetNumAcquired() const { return NumAcquired; }
+
+	/** Instances kept for reuse. */
+	int32 GetNumPooled() const { return Entries.Num(); }
+
+private:
+	TArray<TSharedPtr<TargetDataType>, TInlineAllocator<MaxPooled>> Entries;
+	FGameplayAbilityTargetDataHandle Handle;
+	int32 NumAllocations = 0;
+	int32 NumAcquired = 0;
+};
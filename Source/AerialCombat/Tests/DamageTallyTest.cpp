@@ -0,0 +1,159 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "DamageTally.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// Stand-in for a Vehicle, the Tally only Keeps its Address
+	struct FTallyTestTarget
+	{
+		float Health = 100.0f;
+	};
+
+	// Hits as the Old Resolver Counted them: Rescan the Queue for each New Target's Later Hits, O(n^2)
+	struct FTallyTestHit
+	{
+		FTallyTestTarget* Target = nullptr;
+		FTallyTestTarget* Shooter = nullptr;
+		float Damage = 0.0f;
+	};
+
+	float ResolveByRescan(TArray<FTallyTestHit>& Hits)
+	{
+		float Checksum = 0.0f;
+		for (int32 First = 0; First < Hits.Num(); ++First)
+		{
+			FTallyTestTarget* Target = Hits[First].Target;
+			if (!Target)
+				continue;
+
+			float Health = Target->Health;
+			float TotalDamage = 0.0f;
+			for (int32 i = First; i < Hits.Num(); ++i)
+			{
+				if (Hits[i].Target != Target)
+					continue;
+
+				if (Health > 0.0f)
+				{
+					Health -= Hits[i].Damage;
+					TotalDamage += Hits[i].Damage;
+				}
+				Hits[i].Target = nullptr;
+			}
+			Checksum += TotalDamage;
+		}
+		return Checksum;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDamageTallyOrderTest, "AerialCombat.Damage.Tally.Order",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDamageTallyOrderTest::RunTest(const FString& Parameters)
+{
+	FTallyTestTarget A, B, ShooterX, ShooterY;
+	B.Health = 25.0f;
+
+	TDamageTally<FTallyTestTarget> Tally;
+	int32 NumHealthReads = 0;
+	auto AddHit = [&Tally, &NumHealthReads](FTallyTestTarget& Target, FTallyTestTarget& Shooter, float Damage)
+	{
+		Tally.AddHit(&Target, &Shooter, Damage, [&Target, &NumHealthReads]() { ++NumHealthReads; return Target.Health; });
+	};
+
+	// Interleaved Hits: B Dies to Y's Second Hit, X's Last Hit on B doesn't Count
+	AddHit(B, ShooterX, 10.0f);
+	AddHit(A, ShooterX, 10.0f);
+	AddHit(B, ShooterY, 10.0f);
+	AddHit(A, ShooterY, 10.0f);
+	AddHit(B, ShooterY, 10.0f);
+	AddHit(B, ShooterX, 10.0f);
+
+	const TArray<TDamageTally<FTallyTestTarget>::FTargetTally>& Tallies = Tally.GetTallies();
+	TestEqual(TEXT("One Tally per Target"), Tallies.Num(), 2);
+	TestEqual(TEXT("Health Read once per Target"), NumHealthReads, 2);
+	if (Tallies.Num() != 2)
+		return false;
+
+	TestTrue(TEXT("Targets in Order of First Hit"), Tallies[0].Target == &B && Tallies[1].Target == &A);
+
+	TestEqual(TEXT("Hits after the Kill Ignored"), Tallies[0].TotalDamage, 30.0f);
+	TestEqual(TEXT("Counted Hits on the Killed Target"), Tallies[0].NumHits, 3);
+	TestTrue(TEXT("Killer is the Last Counted Shooter"), Tallies[0].LastShooter == &ShooterY);
+
+	TestEqual(TEXT("Surviving Target Takes every Hit"), Tallies[1].TotalDamage, 20.0f);
+	TestTrue(TEXT("Last Shooter of the Surviving Target"), Tallies[1].LastShooter == &ShooterY);
+
+	Tally.Reset();
+	TestEqual(TEXT("Reset Forgets the Frame"), Tally.GetTallies().Num(), 0);
+
+	return true;
+}
+
+// A Frame of Massed Fire: 64 Targets, Hits Spread over all of them, Tally vs the Old Rescan
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDamageTallyStressTest, "AerialCombat.Damage.Tally.Stress",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FDamageTallyStressTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumTargets = 64;
+	constexpr int32 NumFrames = 100;
+	constexpr float Damage = 1.0f;
+
+	TArray<FTallyTestTarget> Targets;
+	Targets.SetNum(NumTargets);
+
+	for (const int32 NumHits : { 256, 1024, 4096 })
+	{
+		FRandomStream Random(NumHits);
+		TArray<FTallyTestHit> Hits;
+		Hits.SetNum(NumHits);
+		for (FTallyTestHit& Hit : Hits)
+		{
+			Hit.Target = &Targets[Random.RandRange(0, NumTargets - 1)];
+			Hit.Shooter = &Targets[Random.RandRange(0, NumTargets - 1)];
+			Hit.Damage = Damage;
+		}
+
+		TDamageTally<FTallyTestTarget> Tally;
+		float TallyChecksum = 0.0f;
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (const FTallyTestHit& Hit : Hits)
+			{
+				FTallyTestTarget* Target = Hit.Target;
+				Tally.AddHit(Target, Hit.Shooter, Hit.Damage, [Target]() { return Target->Health; });
+			}
+			TallyChecksum = 0.0f;
+			for (const TDamageTally<FTallyTestTarget>::FTargetTally& TargetTally : Tally.GetTallies())
+			{
+				TallyChecksum += TargetTally.TotalDamage;
+			}
+			Tally.Reset();
+		}
+		const double TallySeconds = FPlatformTime::Seconds() - StartTime;
+
+		float RescanChecksum = 0.0f;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			TArray<FTallyTestHit> FrameHits = Hits;
+			RescanChecksum = ResolveByRescan(FrameHits);
+		}
+		const double RescanSeconds = FPlatformTime::Seconds() - StartTime;
+
+		AddInfo(FString::Printf(TEXT("%d Hits on %d Targets: Tally %.2f us/Frame, Rescan %.2f us/Frame"),
+			NumHits, NumTargets, TallySeconds * 1e6 / NumFrames, RescanSeconds * 1e6 / NumFrames));
+
+		TestEqual(FString::Printf(TEXT("Same Damage Dealt (%d Hits)"), NumHits), TallyChecksum, RescanChecksum);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "FakeProjectileTable.h"
+#include "Projectile.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Entries are Checked by Key, every one Points at the Projectile CDO
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFakeProjectileTableProbeTest, "AerialCombat.Projectiles.FakeProjectileTable.Probing",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FFakeProjectileTableProbeTest::RunTest(const FString& Parameters)
+{
+	AProjectile* Projectile = GetMutableDefault<AProjectile>();
+	constexpr int32 Capacity = FFakeProjectileTable::Capacity;
+
+	// Same Home Slot, Chained by Linear Probing
+	{
+		FFakeProjectileTable Table;
+		Table.Add(5, Projectile, 0.0);
+		Table.Add(static_cast<uint16>(5 + Capacity), Projectile, 0.0);
+		Table.Add(static_cast<uint16>(5 + 2 * Capacity), Projectile, 0.0);
+		TestEqual(TEXT("Colliding Ids Added"), Table.Num(), 3);
+
+		// Delete then Find: the Rest of the Chain is still Reachable after the Backward Shift
+		TestTrue(TEXT("Remove Middle of Chain"), Table.Remove(static_cast<uint16>(5 + Capacity)));
+		TestNull(TEXT("Removed Id not Found"), Table.Find(static_cast<uint16>(5 + Capacity)));
+		TestNotNull(TEXT("Head of Chain Found"), Table.Find(5));
+		TestNotNull(TEXT("Tail of Chain Found"), Table.Find(static_cast<uint16>(5 + 2 * Capacity)));
+		TestFalse(TEXT("Second Remove Fails"), Table.Remove(static_cast<uint16>(5 + Capacity)));
+
+		TestTrue(TEXT("Remove Head of Chain"), Table.Remove(5));
+		TestNotNull(TEXT("Tail Found after Head Removed"), Table.Find(static_cast<uint16>(5 + 2 * Capacity)));
+		TestEqual(TEXT("One Left"), Table.Num(), 1);
+	}
+
+	// Probe Run Wrapping past the Last Slot, Mixed with an Entry whose Home is Slot 0
+	{
+		FFakeProjectileTable Table;
+		constexpr int32 LastHome = Capacity - 1;
+		Table.Add(static_cast<uint16>(LastHome), Projectile, 0.0); // Slot 255
+		Table.Add(static_cast<uint16>(LastHome + Capacity), Projectile, 0.0); // Wraps to Slot 0
+		Table.Add(static_cast<uint16>(LastHome + 2 * Capacity), Projectile, 0.0); // Slot 1
+		Table.Add(static_cast<uint16>(Capacity), Projectile, 0.0); // Home 0, Displaced to Slot 2
+
+		TestTrue(TEXT("Remove Start of Wrapped Run"), Table.Remove(static_cast<uint16>(LastHome)));
+		TestNotNull(TEXT("Wrapped Entry Found"), Table.Find(static_cast<uint16>(LastHome + Capacity)));
+		TestNotNull(TEXT("Second Wrapped Entry Found"), Table.Find(static_cast<uint16>(LastHome + 2 * Capacity)));
+		TestNotNull(TEXT("Displaced Entry Found"), Table.Find(static_cast<uint16>(Capacity)));
+
+		TestTrue(TEXT("Remove Wrapped Entry"), Table.Remove(static_cast<uint16>(LastHome + Capacity)));
+		TestNotNull(TEXT("Displaced Entry Found after Shift"), Table.Find(static_cast<uint16>(Capacity)));
+		TestNotNull(TEXT("Last Wrapped Entry Found after Shift"), Table.Find(static_cast<uint16>(LastHome + 2 * Capacity)));
+		TestEqual(TEXT("Two Left"), Table.Num(), 2);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFakeProjectileTableWrapTest, "AerialCombat.Projectiles.FakeProjectileTable.Wraparound",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FFakeProjectileTableWrapTest::RunTest(const FString& Parameters)
+{
+	AProjectile* Projectile = GetMutableDefault<AProjectile>();
+	constexpr int32 Capacity = FFakeProjectileTable::Capacity;
+
+	// 16-bit Ids Wrap from 65535 to 1 (0 is NULL_PROJECTILE_ID)
+	{
+		FFakeProjectileTable Table;
+		Table.Add(MAX_uint16, Projectile, 0.0);
+		Table.Add(1, Projectile, 0.0);
+		TestNotNull(TEXT("Last Id Found"), Table.Find(MAX_uint16));
+		TestNotNull(TEXT("Wrapped Id Found"), Table.Find(1));
+		TestNull(TEXT("Null Id never Found"), Table.Find(NULL_PROJECTILE_ID));
+
+		// An Id that Wrapped onto a Live Entry Replaces it
+		Table.Add(1, Projectile, 1.0);
+		TestEqual(TEXT("Reused Id doesn't Grow the Table"), Table.Num(), 2);
+		TestEqual(TEXT("Reused Id Counted as Overwritten"), Table.GetStats().NumOverwritten, 1);
+	}
+
+	// A Full Table Drops its Oldest Entry
+	{
+		FFakeProjectileTable Table;
+		for (int32 i = 0; i < Capacity; ++i)
+		{
+			Table.Add(static_cast<uint16>(i + 1), Projectile, i);
+		}
+		Table.Add(static_cast<uint16>(Capacity + 1), Projectile, Capacity);
+
+		TestEqual(TEXT("Full Table keeps its Capacity"), Table.Num(), Capacity);
+		TestNull(TEXT("Oldest Entry Dropped"), Table.Find(1));
+		TestNotNull(TEXT("Newest Entry Found"), Table.Find(static_cast<uint16>(Capacity + 1)));
+		TestNotNull(TEXT("Second Oldest Entry Kept"), Table.Find(2));
+	}
+
+	// Expiry Removes exactly the Old Entries, and the Rest stay Reachable
+	{
+		FFakeProjectileTable Table;
+		for (int32 i = 0; i < 40; ++i)
+		{
+			// Every Id Homes to one of Four Slots, so Expiry has to Shift Chains
+			Table.Add(static_cast<uint16>((i % 4) + 1 + (i / 4) * Capacity), Projectile, i);
+		}
+
+		TestEqual(TEXT("Expired Count"), Table.ExpireOlderThan(20.0), 20);
+		TestEqual(TEXT("Left after Expiry"), Table.Num(), 20);
+		for (int32 i = 20; i < 40; ++i)
+		{
+			TestNotNull(TEXT("Young Entry Found after Expiry"), Table.Find(static_cast<uint16>((i % 4) + 1 + (i / 4) * Capacity)));
+		}
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "CombatVehicle.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMoveQueueOrderTest, "AerialCombat.Net.MoveQueue.Order",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMoveQueueOrderTest::RunTest(const FString& Parameters)
+{
+	FNetClientPredStats Stats;
+	const int Capacity = FNetClientPredStats::MaxMovesInQueue;
+
+	// Overfill, the Oldest Moves are Overwritten
+	for (uint32 Sequence = 1; Sequence <= static_cast<uint32>(Capacity + 10); ++Sequence)
+	{
+		FNetClientMove Move;
+		Move.Sequence = Sequence;
+		Stats.AddMove(Move);
+	}
+	TestEqual(TEXT("Queue is Full"), Stats.GetNumOfMoves(), Capacity);
+	TestEqual(TEXT("Oldest Move after Overwrite"), Stats.GetMove(0).Sequence, 11u);
+	TestEqual(TEXT("Newest Move after Overwrite"), Stats.GetMove(Capacity - 1).Sequence, static_cast<uint32>(Capacity + 10));
+
+	// Batches Carry the Newest Moves, even when the Ack is further behind than a Batch
+	TArray<FNetClientMove> Newest;
+	Stats.GetNewestMoves(32, Newest);
+	TestEqual(TEXT("Batch Capped"), Newest.Num(), 32);
+	TestEqual(TEXT("Batch Starts after the Skipped Backlog"), Newest[0].Sequence, static_cast<uint32>(Capacity + 10 - 31));
+	TestEqual(TEXT("Batch Ends with the Newest Move"), Newest.Last().Sequence, static_cast<uint32>(Capacity + 10));
+	Stats.GetNewestMoves(Capacity * 2, Newest);
+	TestEqual(TEXT("Batch Limited by the Queue"), Newest.Num(), Capacity);
+
+	Stats.RemoveAcknowledgedMoves(20);
+	TestEqual(TEXT("Acknowledged Prefix Removed"), Stats.GetMove(0).Sequence, 21u);
+
+	// Acknowledging an Older Move is a No-Op
+	Stats.RemoveAcknowledgedMoves(5);
+	TestEqual(TEXT("Stale Ack Ignored"), Stats.GetMove(0).Sequence, 21u);
+
+	TestEqual(TEXT("Extract Oldest"), Stats.ExtractMove().Sequence, 21u);
+	Stats.RemoveAcknowledgedMoves(static_cast<uint32>(Capacity + 10));
+	TestTrue(TEXT("Queue Empty after Full Ack"), Stats.IsMoveQueueEmpty());
+
+	return true;
+}
+
+// Client Move Queue at 60/120/240 Hz with 64 to 1024 Moves in Flight, Ring Buffer vs the Old TArray Queue. Acks
+// arrive with the Server's Net Updates (30 Hz), each Dropping a Net Frame's Worth of Moves.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMoveQueueBenchmarkTest, "AerialCombat.Net.MoveQueue.Benchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FMoveQueueBenchmarkTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 SimulatedSeconds = 120;
+	constexpr int32 AckRate = 30;
+
+	// Holds the Deepest Queue plus the Moves between two Acks at the Fastest Rate
+	using FBenchmarkQueue = TNetMoveQueue<2048>;
+
+	for (const int32 TickRate : { 60, 120, 240 })
+	{
+		const int32 NumMoves = TickRate * SimulatedSeconds;
+		const int32 MovesPerAck = FMath::Max(TickRate / AckRate, 1);
+
+		for (const int32 MovesInFlight : { 64, 128, 256, 512, 1024 })
+		{
+			TUniquePtr<FBenchmarkQueue> Ring = MakeUnique<FBenchmarkQueue>();
+			double StartTime = FPlatformTime::Seconds();
+			for (int32 Sequence = 1; Sequence <= NumMoves; ++Sequence)
+			{
+				FNetClientMove Move;
+				Move.Sequence = Sequence;
+				Ring->AddMove(Move);
+				if (Sequence % MovesPerAck == 0 && Sequence > MovesInFlight)
+				{
+					Ring->RemoveAcknowledgedMoves(Sequence - MovesInFlight);
+				}
+			}
+			const double RingSeconds = FPlatformTime::Seconds() - StartTime;
+
+			TArray<FNetClientMove> Array;
+			StartTime = FPlatformTime::Seconds();
+			for (int32 Sequence = 1; Sequence <= NumMoves; ++Sequence)
+			{
+				FNetClientMove Move;
+				Move.Sequence = Sequence;
+				Array.Add(Move);
+				if (Sequence % MovesPerAck == 0 && Sequence > MovesInFlight)
+				{
+					const uint32 AckSequence = Sequence - MovesInFlight;
+					while (Array.Num() > 0 && Array[0].Sequence <= AckSequence)
+					{
+						Array.RemoveAt(0);
+					}
+				}
+			}
+			const double ArraySeconds = FPlatformTime::Seconds() - StartTime;
+
+			AddInfo(FString::Printf(TEXT("%d Hz, %d Moves in Flight: Ring Buffer %.2f ns/Move (%.1f us/s), TArray RemoveAt(0) %.2f ns/Move (%.1f us/s)"),
+				TickRate, MovesInFlight,
+				RingSeconds * 1e9 / NumMoves, RingSeconds * 1e6 / SimulatedSeconds,
+				ArraySeconds * 1e9 / NumMoves, ArraySeconds * 1e6 / SimulatedSeconds));
+
+			TestEqual(FString::Printf(TEXT("Same Moves in Flight (%d Hz, %d)"), TickRate, MovesInFlight), Ring->GetNumOfMoves(), Array.Num());
+		}
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,311 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "CombatVehicle.h"
+#include "VehicleMovementModel.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace NetPredictionTest
+{
+	// One Stretch of the Recorded Input Stream, Held for NumSteps Fixed Steps
+	struct FInputSegment
+	{
+		int32 NumSteps = 0;
+		float Forward = 0.0f;
+		float Steering = 0.0f;
+		float Vertical = 0.0f;
+		float Boost = 0.0f;
+		float BoostPitch = 0.0f;
+	};
+
+	// A Recorded Flight at 60 Steps per Second: Climb, Cruise, Weave, Boost, Coast, Reverse, Descend and Hover
+	const FInputSegment RecordedFlight[] = {
+		{ 60, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f },
+		{ 120, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+		{ 45, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f },
+		{ 45, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f },
+		{ 90, 1.0f, 0.0f, 0.0f, 1.0f, -10.0f },
+		{ 30, 1.0f, 1.0f, 0.0f, 1.0f, -10.0f },
+		{ 60, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+		{ 30, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+		{ 60, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f },
+		{ 120, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+	};
+
+	// One Way of an Unreliable Connection: Fixed Latency (in Steps) and Random Loss, Packets Arrive in Order
+	template<typename PayloadType>
+	class TSimulatedLink
+	{
+	public:
+		TSimulatedLink(int32 InLatencySteps, float InLossPct, int32 Seed)
+			: LatencySteps(InLatencySteps), LossPct(InLossPct), Random(Seed)
+		{
+		}
+
+		void Send(int32 Step, const PayloadType& Payload)
+		{
+			if (Random.FRand() * 100.0f < LossPct)
+				return;
+
+			InFlight.Add({ Step + LatencySteps, Payload });
+		}
+
+		// Packets that have Arrived by Step, Oldest First
+		void Receive(int32 Step, TArray<PayloadType>& OutPayloads)
+		{
+			OutPayloads.Reset();
+			int32 NumArrived = 0;
+			while (NumArrived < InFlight.Num() && InFlight[NumArrived].Key <= Step)
+			{
+				OutPayloads.Add(InFlight[NumArrived].Value);
+				++NumArrived;
+			}
+			InFlight.RemoveAt(0, NumArrived);
+		}
+
+	private:
+		int32 LatencySteps;
+		float LossPct;
+		FRandomStream Random;
+		TArray<TPair<int32, PayloadType>> InFlight;
+	};
+
+	struct FReplayScenario
+	{
+		float LatencySeconds = 0.0f; // One Way
+		float LossPct = 0.0f;
+		int32 Seed = 1;
+	};
+
+	struct FReplayResult
+	{
+		int32 NumMoves = 0;
+		int32 NumReplays = 0;
+		int32 NumCorrections = 0;
+		int32 NumMovesMissed = 0; // Never Reached the Server
+		float MaxCorrection = 0.0f;
+		float TotalCorrection = 0.0f;
+		float MaxApplyDelay = 0.0f; // Seconds from Predicting a Move to the Server Applying it
+		TArray<int32> QueueDepths; // Unacknowledged Moves after each Step
+	};
+
+	/**
+	 * Flies Inputs through the same pieces the vehicle uses: the client predicts every step and queues the move, sends
+	 * the newest unacknowledged moves at NetMoveSendRate over a lossy, delayed link, the server applies the new ones
+	 * and publishes quantized stats at ServerStatsPublishRate when they changed or the ack fell ServerAckPublishGap
+	 * behind, and the client replays from every stats it receives, snapping when the error is over
+	 * MaxNetPredictionError. Collision and the move rate budget are left out.
+	 */
+	FReplayResult RunReplay(TConstArrayView<FInputSegment> Inputs, const FReplayScenario& Scenario)
+	{
+		const ACombatVehicle* Defaults = GetDefault<ACombatVehicle>();
+		const FVehicleMovementParams Params;
+		const float StepSeconds = Params.FixedStepSeconds;
+
+		const int32 LatencySteps = FMath::RoundToInt(Scenario.LatencySeconds / StepSeconds);
+		const int32 SendSteps = FMath::Max(FMath::RoundToInt(1.0f / (FMath::Max(Defaults->NetMoveSendRate, 1.0f) * StepSeconds)), 1);
+		const int32 PublishSteps = FMath::Max(FMath::RoundToInt(1.0f / (FMath::Max(Defaults->ServerStatsPublishRate, 1.0f) * StepSeconds)), 1);
+		const int32 MaxToSend = FMath::Min(FMath::Max(Defaults->NetMaxMovesPerBatch, 1), static_cast<int32>(FNetClientMoveBatch::MaxMovesPerBatch));
+
+		TSimulatedLink<FNetClientMoveBatch> UpLink(LatencySteps, Scenario.LossPct, Scenario.Seed);
+		TSimulatedLink<FNetServerStats> DownLink(LatencySteps, Scenario.LossPct, Scenario.Seed + 1);
+
+		// Client
+		FNetClientPredStats MoveQueue;
+		FVehicleMovementState ClientState;
+		uint32 NextSequence = 1;
+		uint32 ClientAckSequence = 0;
+
+		// Server
+		FVehicleMovementState ServerState;
+		FNetServerStats ServerStats;
+		uint32 ServerAckSequence = 0;
+		bool bServerStatsPending = false;
+
+		FReplayResult Result;
+		TArray<FNetClientMoveBatch> ArrivedBatches;
+		TArray<FNetServerStats> ArrivedStats;
+
+		int32 Step = 0;
+		for (const FInputSegment& Segment : Inputs)
+		{
+			for (int32 SegmentStep = 0; SegmentStep < Segment.NumSteps; ++SegmentStep, ++Step)
+			{
+				// Client Predicts the Recorded Input
+				FNetClientMove Move;
+				Move.Sequence = NextSequence++;
+				Move.InputForward = Segment.Forward;
+				Move.InputSteering = Segment.Steering;
+				Move.InputVertical = Segment.Vertical;
+				Move.InputBoost = Segment.Boost;
+				Move.BoostRotation = FRotator(Segment.BoostPitch, 0.0f, 0.0f);
+				Move.QuantizeBoostRotation();
+
+				ClientState = FVehicleMovementModel::Step(Params, ClientState, ACombatVehicle::MakeMoveInput(Move));
+				MoveQueue.AddMove(Move);
+				++Result.NumMoves;
+
+				if (Step % SendSteps == 0)
+				{
+					FNetClientMoveBatch Batch;
+					MoveQueue.GetNewestMoves(MaxToSend, Batch.Moves);
+					UpLink.Send(Step, Batch);
+				}
+
+				// Server Applies the Moves it hasn't Seen
+				UpLink.Receive(Step, ArrivedBatches);
+				for (const FNetClientMoveBatch& Batch : ArrivedBatches)
+				{
+					for (const FNetClientMove& BatchMove : Batch.Moves)
+					{
+						const int32 SequenceDelta = static_cast<int32>(BatchMove.Sequence - ServerAckSequence);
+						if (SequenceDelta <= 0)
+							continue;
+
+						Result.NumMovesMissed += SequenceDelta - 1;
+						ServerState = FVehicleMovementModel::Step(Params, ServerState, ACombatVehicle::MakeMoveInput(BatchMove));
+						ServerAckSequence = BatchMove.Sequence;
+						Result.MaxApplyDelay = FMath::Max(Result.MaxApplyDelay, (Step - static_cast<int32>(BatchMove.Sequence - 1)) * StepSeconds);
+
+						if (!bServerStatsPending)
+						{
+							bServerStatsPending = ServerStats.DiffersFrom(ServerState)
+								|| static_cast<int32>(ServerAckSequence - ServerStats.AckSequence) >= FMath::Max(Defaults->ServerAckPublishGap, 1);
+						}
+					}
+				}
+
+				// Server Publishes, and Continues from the Quantized State
+				if (Step % PublishSteps == 0 && bServerStatsPending)
+				{
+					ServerStats.AckSequence = ServerAckSequence;
+					ServerStats.SetMovementState(ServerState);
+					ServerStats.Quantize();
+					ServerState = ServerStats.GetMovementState();
+					DownLink.Send(Step, ServerStats);
+					bServerStatsPending = false;
+				}
+
+				// Client Reconciles with every Newer Stats
+				DownLink.Receive(Step, ArrivedStats);
+				for (const FNetServerStats& Stats : ArrivedStats)
+				{
+					if (static_cast<int32>(Stats.AckSequence - ClientAckSequence) <= 0)
+						continue;
+
+					ClientAckSequence = Stats.AckSequence;
+					MoveQueue.RemoveAcknowledgedMoves(Stats.AckSequence);
+
+					FVehicleMovementState Replayed = Stats.GetMovementState();
+					for (int32 i = 0; i < MoveQueue.GetNumOfMoves(); ++i)
+					{
+						Replayed = FVehicleMovementModel::Step(Params, Replayed, ACombatVehicle::MakeMoveInput(MoveQueue.GetMove(i)));
+					}
+					++Result.NumReplays;
+
+					const float Error = FVector::Dist(ClientState.Location, Replayed.Location);
+					if (Error > Defaults->MaxNetPredictionError)
+					{
+						ClientState = Replayed;
+						++Result.NumCorrections;
+						Result.MaxCorrection = FMath::Max(Result.MaxCorrection, Error);
+						Result.TotalCorrection += Error;
+					}
+				}
+
+				Result.QueueDepths.Add(MoveQueue.GetNumOfMoves());
+			}
+		}
+
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNetPredictionReplayTest, "AerialCombat.Net.Prediction.Replay",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FNetPredictionReplayTest::RunTest(const FString& Parameters)
+{
+	using namespace NetPredictionTest;
+
+	for (const float LatencySeconds : { 0.0f, 0.05f, 0.1f, 0.2f })
+	{
+		for (const float LossPct : { 0.0f, 5.0f, 20.0f })
+		{
+			FReplayScenario Scenario;
+			Scenario.LatencySeconds = LatencySeconds;
+			Scenario.LossPct = LossPct;
+			const FReplayResult Result = RunReplay(RecordedFlight, Scenario);
+
+			AddInfo(FString::Printf(TEXT("%3.0f ms, %2.0f%% Loss: %d Corrections in %d Replays (Max %.1f cm, Avg %.1f cm), %d of %d Moves Missed, Applied up to %.0f ms Late"),
+				LatencySeconds * 1000.0f, LossPct, Result.NumCorrections, Result.NumReplays, Result.MaxCorrection,
+				Result.NumCorrections > 0 ? Result.TotalCorrection / Result.NumCorrections : 0.0f,
+				Result.NumMovesMissed, Result.NumMoves, Result.MaxApplyDelay * 1000.0f));
+
+			TestTrue(TEXT("Client Reconciled"), Result.NumReplays > 0);
+
+			// Without Loss the Server Applies every Predicted Move, only Quantization Separates the two
+			if (LossPct == 0.0f)
+			{
+				TestEqual(FString::Printf(TEXT("No Moves Missed at %.0f ms"), LatencySeconds * 1000.0f), Result.NumMovesMissed, 0);
+				TestEqual(FString::Printf(TEXT("No Corrections at %.0f ms"), LatencySeconds * 1000.0f), Result.NumCorrections, 0);
+			}
+		}
+	}
+
+	return true;
+}
+
+// Cruise, Settle into a Hover for 10 Seconds, then Cruise again: the Ack has to Keep up while Nothing Changes
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNetPredictionIdleTest, "AerialCombat.Net.Prediction.IdleThenMove",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FNetPredictionIdleTest::RunTest(const FString& Parameters)
+{
+	using namespace NetPredictionTest;
+
+	const ACombatVehicle* Defaults = GetDefault<ACombatVehicle>();
+	const float StepSeconds = FVehicleMovementParams().FixedStepSeconds;
+
+	constexpr int32 CruiseSteps = 60;
+	constexpr int32 IdleSteps = 600;
+	const FInputSegment IdleThenMove[] = {
+		{ CruiseSteps, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+		{ IdleSteps, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+		{ CruiseSteps, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+	};
+
+	for (const float LatencySeconds : { 0.05f, 0.1f })
+	{
+		FReplayScenario Scenario;
+		Scenario.LatencySeconds = LatencySeconds;
+		const FReplayResult Result = RunReplay(IdleThenMove, Scenario);
+
+		// Second Half of the Idle Stretch, once the Vehicle has Settled
+		int32 MaxIdleQueueDepth = 0;
+		for (int32 Step = CruiseSteps + IdleSteps / 2; Step < CruiseSteps + IdleSteps; ++Step)
+		{
+			MaxIdleQueueDepth = FMath::Max(MaxIdleQueueDepth, Result.QueueDepths[Step]);
+		}
+
+		AddInfo(FString::Printf(TEXT("%3.0f ms: Up to %d Unacknowledged Moves while Idle, %d Corrections, Moves Applied up to %.0f ms Late"),
+			LatencySeconds * 1000.0f, MaxIdleQueueDepth, Result.NumCorrections, Result.MaxApplyDelay * 1000.0f));
+
+		// Ack Gap, plus a Round Trip and a Send and Publish Interval of Moves in Flight
+		const int32 RoundTripSteps = 2 * FMath::RoundToInt(LatencySeconds / StepSeconds);
+		const int32 IntervalSteps = FMath::CeilToInt(1.0f / (Defaults->NetMoveSendRate * StepSeconds)) + FMath::CeilToInt(1.0f / (Defaults->ServerStatsPublishRate * StepSeconds));
+		TestTrue(FString::Printf(TEXT("Idle Ack Keeps up at %.0f ms"), LatencySeconds * 1000.0f),
+			MaxIdleQueueDepth <= Defaults->ServerAckPublishGap + RoundTripSteps + IntervalSteps);
+		TestTrue(TEXT("Idle Queue never Fills"), MaxIdleQueueDepth < FNetClientPredStats::MaxMovesInQueue);
+
+		// Moving again, the Newest Input Reaches the Server a Send Interval after the Latency at most
+		TestTrue(FString::Printf(TEXT("Moves Applied on Time at %.0f ms"), LatencySeconds * 1000.0f),
+			Result.MaxApplyDelay <= LatencySeconds + 1.0f / Defaults->NetMoveSendRate + StepSeconds);
+		TestEqual(FString::Printf(TEXT("No Corrections at %.0f ms"), LatencySeconds * 1000.0f), Result.NumCorrections, 0);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "UObject/CoreNet.h"
+#include "CombatVehicle.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace NetSerializationTest
+{
+	// Write Value with its NetSerialize and Read it back into a Fresh Struct
+	template<typename StructType>
+	StructType RoundTrip(const StructType& Value, int64& OutNumBits)
+	{
+		bool bSuccess = false;
+		FNetBitWriter Writer(nullptr, 4096);
+		const_cast<StructType&>(Value).NetSerialize(Writer, nullptr, bSuccess);
+		OutNumBits = Writer.GetNumBits();
+
+		StructType Result;
+		FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+		Result.NetSerialize(Reader, nullptr, bSuccess);
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNetServerStatsRoundTripTest, "AerialCombat.Net.Serialization.ServerStats",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FNetServerStatsRoundTripTest::RunTest(const FString& Parameters)
+{
+	FNetServerStats Stats;
+	Stats.AckSequence = 123456;
+	Stats.Location = FVector(-81234.567, 40321.005, 2519.999);
+	Stats.Rotation = FRotator(12.3f, -170.4f, 5.6f);
+	Stats.Velocity = FVector(4999.96, -250.04, 17.5);
+	Stats.YawVelocity = -37.77f;
+	Stats.HoverTime = 80.0f; // Past the Sent Range
+	Stats.HoverMaxVelocity = -149.9f;
+
+	int64 NumBits = 0;
+	const FNetServerStats Received = NetSerializationTest::RoundTrip(Stats, NumBits);
+
+	// Quantize must give exactly what the Owning Client Receives
+	FNetServerStats Quantized = Stats;
+	Quantized.Quantize();
+
+	TestEqual(TEXT("AckSequence"), Received.AckSequence, Stats.AckSequence);
+	TestTrue(TEXT("Location"), Received.Location.Equals(Quantized.Location, 0.0));
+	TestTrue(TEXT("Velocity"), Received.Velocity.Equals(Quantized.Velocity, 0.0));
+	TestTrue(TEXT("Rotation"), Received.Rotation.Equals(Quantized.Rotation, 0.0f));
+	TestEqual(TEXT("YawVelocity"), Received.YawVelocity, Quantized.YawVelocity);
+	TestEqual(TEXT("HoverTime"), Received.HoverTime, Quantized.HoverTime);
+	TestEqual(TEXT("HoverMaxVelocity"), Received.HoverMaxVelocity, Quantized.HoverMaxVelocity);
+
+	// And stay within the Documented Precision
+	TestTrue(TEXT("Location Precision"), Received.Location.Equals(Stats.Location, 0.005 + UE_KINDA_SMALL_NUMBER));
+	TestTrue(TEXT("Velocity Precision"), Received.Velocity.Equals(Stats.Velocity, 0.05 + UE_KINDA_SMALL_NUMBER));
+	TestTrue(TEXT("HoverTime Clamped"), Received.HoverTime <= 64.0f);
+
+	// Quantizing Twice changes Nothing
+	FNetServerStats Requantized = Quantized;
+	Requantized.Quantize();
+	TestTrue(TEXT("Quantize is Idempotent"), Requantized.Location.Equals(Quantized.Location, 0.0) && Requantized.YawVelocity == Quantized.YawVelocity);
+
+	AddInfo(FString::Printf(TEXT("FNetServerStats: %lld bits"), NumBits));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNetClientMoveBatchRoundTripTest, "AerialCombat.Net.Serialization.MoveBatch",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FNetClientMoveBatchRoundTripTest::RunTest(const FString& Parameters)
+{
+	FNetClientMoveBatch Batch;
+	for (int32 i = 0; i < 12; ++i)
+	{
+		FNetClientMove Move;
+		Move.Sequence = 70000 + i;
+		Move.InputVertical = (i % 3) - 1;
+		Move.InputForward = ((i + 1) % 3) - 1;
+		Move.InputSteering = ((i + 2) % 3) - 1;
+		Move.InputBoost = (i % 4 == 0) ? 1.0f : 0.0f;
+		Move.BoostRotation = Move.InputBoost > 0.0f ? FRotator(15.0f, 0.0f, -7.5f) : FRotator::ZeroRotator;
+		Move.QuantizeBoostRotation();
+		Batch.Moves.Add(Move);
+	}
+
+	int64 NumBits = 0;
+	const FNetClientMoveBatch Received = NetSerializationTest::RoundTrip(Batch, NumBits);
+
+	TestEqual(TEXT("Counted Bits match Written Bits"), static_cast<int64>(Batch.GetNumPayloadBits()), NumBits);
+	if (!TestEqual(TEXT("Move Count"), Received.Moves.Num(), Batch.Moves.Num()))
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < Batch.Moves.Num(); ++i)
+	{
+		const FNetClientMove& Sent = Batch.Moves[i];
+		const FNetClientMove& Got = Received.Moves[i];
+		TestEqual(TEXT("Sequence"), Got.Sequence, Sent.Sequence);
+		TestEqual(TEXT("InputVertical"), Got.InputVertical, Sent.InputVertical);
+		TestEqual(TEXT("InputForward"), Got.InputForward, Sent.InputForward);
+		TestEqual(TEXT("InputSteering"), Got.InputSteering, Sent.InputSteering);
+		TestEqual(TEXT("InputBoost"), Got.InputBoost, Sent.InputBoost);
+		TestTrue(TEXT("BoostRotation"), Got.BoostRotation.Equals(Sent.BoostRotation, 0.0f));
+	}
+
+	// A Batch over the Cap is Refused
+	FNetClientMoveBatch Oversized;
+	Oversized.Moves.SetNum(FNetClientMoveBatch::MaxMovesPerBatch + 1);
+	bool bSuccess = true;
+	FNetBitWriter Writer(nullptr, 4096);
+	Oversized.NetSerialize(Writer, nullptr, bSuccess);
+	FNetClientMoveBatch Refused;
+	FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+	Refused.NetSerialize(Reader, nullptr, bSuccess);
+	TestFalse(TEXT("Oversized Batch Refused"), bSuccess);
+
+	AddInfo(FString::Printf(TEXT("FNetClientMoveBatch of %d Moves: %lld bits"), Batch.Moves.Num(), NumBits));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "TargetDataPool.h"
+#include "AbilityTask_FireBurst.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTargetDataPoolAllocationTest, "AerialCombat.Abilities.TargetDataPool.Allocations",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FTargetDataPoolAllocationTest::RunTest(const FString& Parameters)
+{
+	// A Client Burst: each Batch is Serialized on Send, nothing else Keeps it
+	{
+		TTargetDataPool<FGameplayAbilityTargetData_ProjectileBurst> Pool;
+		FGameplayAbilityTargetData_ProjectileBurst* First = nullptr;
+		Pool.Acquire(First);
+		for (int32 i = 0; i < 1000; ++i)
+		{
+			FGameplayAbilityTargetData_ProjectileBurst* TargetData = nullptr;
+			Pool.Acquire(TargetData);
+			TestTrue(TEXT("Unreferenced Instance Reused"), TargetData == First);
+		}
+		TestEqual(TEXT("Steady Sends Allocate Once"), Pool.GetNumAllocations(), 1);
+		TestEqual(TEXT("Acquires Counted"), Pool.GetNumAcquired(), 1001);
+	}
+
+	// Held References (a Server-side Cache not yet Consumed) make the Pool Grow, up to its Cap
+	{
+		constexpr int32 MaxPooled = 4;
+		TTargetDataPool<FGameplayAbilityTargetData_ProjectileBurst, MaxPooled> Pool;
+		TArray<TSharedPtr<FGameplayAbilityTargetData>> Held;
+		for (int32 i = 0; i < MaxPooled + 2; ++i)
+		{
+			FGameplayAbilityTargetData_ProjectileBurst* TargetData = nullptr;
+			const FGameplayAbilityTargetDataHandle& Handle = Pool.Acquire(TargetData);
+			Held.Add(Handle.Data[0]);
+		}
+		TestEqual(TEXT("Every Held Send Allocates"), Pool.GetNumAllocations(), MaxPooled + 2);
+		TestEqual(TEXT("Pool Capped"), Pool.GetNumPooled(), MaxPooled);
+
+		// Once Released, the Pooled Instances are Reused without Allocating
+		Held.Reset();
+		for (int32 i = 0; i < 100; ++i)
+		{
+			FGameplayAbilityTargetData_ProjectileBurst* TargetData = nullptr;
+			Pool.Acquire(TargetData);
+		}
+		TestEqual(TEXT("No Allocations after Release"), Pool.GetNumAllocations(), MaxPooled + 2);
+	}
+
+	// Separate Pools (one per ASC) never Hand out the Same Instance
+	{
+		TTargetDataPool<FGameplayAbilityTargetData_ProjectileBurst> PoolA;
+		TTargetDataPool<FGameplayAbilityTargetData_ProjectileBurst> PoolB;
+		FGameplayAbilityTargetData_ProjectileBurst* DataA = nullptr;
+		FGameplayAbilityTargetData_ProjectileBurst* DataB = nullptr;
+		PoolA.Acquire(DataA);
+		PoolB.Acquire(DataB);
+		TestTrue(TEXT("Pools don't Share Instances"), DataA != DataB);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,336 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/CoreNet.h"
+#include "VehicleMovementModel.h"
+#include "CombatVehicle.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VehicleMovementModelTest
+{
+	// Cycles through Thrust, Steering, Ascent and Boost so every Branch of the Model is Stepped
+	FVehicleMoveInput MakeInput(int32 Step)
+	{
+		FVehicleMoveInput Input;
+		Input.InputForward = (Step / 30) % 3 - 1;
+		Input.InputSteering = (Step / 45) % 3 - 1;
+		Input.InputVertical = (Step / 70) % 3 - 1;
+		Input.InputBoost = (Step / 200) % 2;
+		Input.BoostPitch = Input.InputBoost > 0.0f ? 10.0f : 0.0f;
+		return Input;
+	}
+
+	// Hold Input for NumSteps
+	FVehicleMovementState Fly(const FVehicleMovementParams& Params, FVehicleMovementState State, const FVehicleMoveInput& Input, int32 NumSteps)
+	{
+		for (int32 Step = 0; Step < NumSteps; ++Step)
+		{
+			State = FVehicleMovementModel::Step(Params, State, Input);
+		}
+		return State;
+	}
+
+	// Write State at Full Precision and Read it back
+	FVehicleMovementState SaveAndLoad(const FVehicleMovementState& State)
+	{
+		auto Serialize = [](FArchive& Ar, FVehicleMovementState& Value)
+		{
+			Ar << Value.Location << Value.Rotation << Value.Velocity << Value.YawVelocity << Value.HoverTime << Value.HoverMaxVelocity;
+		};
+
+		TArray<uint8> Bytes;
+		FMemoryWriter Writer(Bytes);
+		Serialize(Writer, const_cast<FVehicleMovementState&>(State));
+
+		FVehicleMovementState Loaded;
+		FMemoryReader Reader(Bytes);
+		Serialize(Reader, Loaded);
+		return Loaded;
+	}
+
+	// The Client's Move for an Input, with the Boost Tilt Rounded as it Predicts it
+	FNetClientMove MakeMove(const FVehicleMoveInput& Input)
+	{
+		FNetClientMove Move;
+		Move.InputVertical = Input.InputVertical;
+		Move.InputForward = Input.InputForward;
+		Move.InputSteering = Input.InputSteering;
+		Move.InputBoost = Input.InputBoost;
+		Move.BoostRotation = FRotator(Input.BoostPitch, 0.0f, Input.BoostRoll);
+		Move.QuantizeBoostRotation();
+		return Move;
+	}
+
+	// The Move as the Server Receives it: Packed, Serialized and Unpacked
+	FNetClientMove SendMove(const FNetClientMove& Move)
+	{
+		FNetBitWriter Writer(nullptr, 256);
+		const_cast<FNetClientMove&>(Move).SerializeInputs(Writer);
+
+		FNetClientMove Received;
+		FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+		Received.SerializeInputs(Reader);
+		return Received;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVehicleMovementModelThrustTest, "AerialCombat.Movement.Model.Thrust",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FVehicleMovementModelThrustTest::RunTest(const FString& Parameters)
+{
+	const FVehicleMovementParams Params;
+	FVehicleMoveInput Input;
+	Input.InputForward = 1.0f;
+
+	// Speeds up every Step until it Reaches the Max
+	FVehicleMovementState State;
+	float LastSpeed = 0.0f;
+	bool bAlwaysFaster = true;
+	for (int32 Step = 0; Step < 60; ++Step)
+	{
+		State = FVehicleMovementModel::Step(Params, State, Input);
+		bAlwaysFaster &= State.Velocity.Size() > LastSpeed;
+		LastSpeed = State.Velocity.Size();
+	}
+	TestTrue(TEXT("Thrust Speeds the Vehicle up"), bAlwaysFaster);
+	TestEqual(TEXT("Accelerates at MovementAcceleration"), LastSpeed, Params.MovementAcceleration, 1.0f);
+	TestTrue(TEXT("Moves Forward"), State.Location.X > 0.0 && FMath::IsNearlyZero(State.Location.Y));
+
+	State = VehicleMovementModelTest::Fly(Params, State, Input, 600);
+	TestTrue(TEXT("Held at MaxMovementVelocity"), State.Velocity.Size() <= Params.MaxMovementVelocity + Params.MovementAcceleration * Params.FixedStepSeconds);
+	TestTrue(TEXT("Reaches MaxMovementVelocity"), State.Velocity.Size() >= Params.MaxMovementVelocity);
+
+	// Reverse Thrust Backs up at most at the Same Max
+	FVehicleMoveInput Reverse;
+	Reverse.InputForward = -1.0f;
+	State = VehicleMovementModelTest::Fly(Params, FVehicleMovementState(), Reverse, 600);
+	TestTrue(TEXT("Reverse Moves Backward"), State.Location.X < 0.0);
+	TestTrue(TEXT("Reverse Held at MaxMovementVelocity"), State.Velocity.Size() <= Params.MaxMovementVelocity + Params.MovementAcceleration * Params.FixedStepSeconds);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVehicleMovementModelBoostTest, "AerialCombat.Movement.Model.Boost",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FVehicleMovementModelBoostTest::RunTest(const FString& Parameters)
+{
+	const FVehicleMovementParams Params;
+	FVehicleMoveInput Input;
+	Input.InputForward = 1.0f;
+	Input.InputBoost = 1.0f;
+
+	FVehicleMovementState State = VehicleMovementModelTest::Fly(Params, FVehicleMovementState(), Input, 300);
+	TestTrue(TEXT("Boost Goes past MaxMovementVelocity"), State.Velocity.Size() > Params.MaxMovementVelocity);
+	TestTrue(TEXT("Reaches BoostModeMaxVelocity"), State.Velocity.Size() >= Params.BoostModeMaxVelocity);
+	TestTrue(TEXT("Held at BoostModeMaxVelocity"), State.Velocity.Size() <= Params.BoostModeMaxVelocity + Params.BoostModeAcceleration * Params.FixedStepSeconds);
+
+	// Tilted Boost Dives along the Nose
+	Input.BoostPitch = -10.0f;
+	Input.BoostRoll = 5.0f;
+	State = VehicleMovementModelTest::Fly(Params, FVehicleMovementState(), Input, 60);
+	TestEqual(TEXT("Takes the Boost Pitch"), State.Rotation.Pitch, Input.BoostPitch);
+	TestEqual(TEXT("Takes the Boost Roll"), State.Rotation.Roll, Input.BoostRoll);
+	TestTrue(TEXT("Nose Down Boost Dives"), State.Location.Z < 0.0);
+
+	// Boost without Thrust doesn't Move the Vehicle
+	FVehicleMoveInput BoostOnly;
+	BoostOnly.InputBoost = 1.0f;
+	TestTrue(TEXT("Boost alone Stays Put"), VehicleMovementModelTest::Fly(Params, FVehicleMovementState(), BoostOnly, 60).Velocity.IsNearlyZero());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVehicleMovementModelAscentTest, "AerialCombat.Movement.Model.Ascent",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FVehicleMovementModelAscentTest::RunTest(const FString& Parameters)
+{
+	const FVehicleMovementParams Params;
+	FVehicleMoveInput Ascend;
+	Ascend.InputVertical = 1.0f;
+
+	FVehicleMovementState State = VehicleMovementModelTest::Fly(Params, FVehicleMovementState(), Ascend, 60);
+	TestTrue(TEXT("Ascent Climbs"), State.Location.Z > 0.0 && State.Velocity.Z > 0.0);
+	TestTrue(TEXT("Climbs Straight up"), FMath::IsNearlyZero(State.Location.X) && FMath::IsNearlyZero(State.Location.Y));
+
+	State = VehicleMovementModelTest::Fly(Params, State, Ascend, 300);
+	TestTrue(TEXT("Held at MaxAscentVelocity"), State.Velocity.Z <= Params.MaxAscentVelocity + Params.AscentAcceleration * Params.FixedStepSeconds);
+	TestTrue(TEXT("Reaches MaxAscentVelocity"), State.Velocity.Z >= Params.MaxAscentVelocity);
+
+	FVehicleMoveInput Descend;
+	Descend.InputVertical = -1.0f;
+	const double Altitude = State.Location.Z;
+	State = VehicleMovementModelTest::Fly(Params, State, Descend, 300);
+	TestTrue(TEXT("Descent Sinks"), State.Location.Z < Altitude && State.Velocity.Z < 0.0);
+	TestTrue(TEXT("Held at MaxDescentVelocity"), State.Velocity.Z >= Params.MaxDescentVelocity + Params.DescentAcceleration * Params.FixedStepSeconds);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVehicleMovementModelHoverTest, "AerialCombat.Movement.Model.Hover",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FVehicleMovementModelHoverTest::RunTest(const FString& Parameters)
+{
+	const FVehicleMovementParams Params;
+	const FVehicleMoveInput NoInput;
+
+	// A Vehicle at Rest Holds its Altitude Exactly
+	FVehicleMovementState State;
+	State.Location = FVector(0.0, 0.0, 1000.0);
+	State = VehicleMovementModelTest::Fly(Params, State, NoInput, 600);
+	TestEqual(TEXT("Resting Vehicle Holds Altitude"), State.Location.Z, 1000.0);
+
+	// Released mid Climb it Wobbles about the Release Altitude and Settles
+	FVehicleMoveInput Ascend;
+	Ascend.InputVertical = 1.0f;
+	State = VehicleMovementModelTest::Fly(Params, FVehicleMovementState(), Ascend, 120);
+	const double ReleaseAltitude = State.Location.Z;
+	const float ReleaseVelocity = State.Velocity.Z;
+
+	double MinAltitude = ReleaseAltitude;
+	double MaxAltitude = ReleaseAltitude;
+	for (int32 Step = 0; Step < 1200; ++Step)
+	{
+		State = FVehicleMovementModel::Step(Params, State, NoInput);
+		MinAltitude = FMath::Min(MinAltitude, State.Location.Z);
+		MaxAltitude = FMath::Max(MaxAltitude, State.Location.Z);
+	}
+	AddInfo(FString::Printf(TEXT("Released at %.0f cm/s: Wobbled between %.1f and %.1f cm about the Release Altitude"),
+		ReleaseVelocity, MinAltitude - ReleaseAltitude, MaxAltitude - ReleaseAltitude));
+
+	// The Wobble is Bounded by the Released Velocity over the Wobble Frequency
+	const double MaxWobble = Params.WobbleAmplitude * FMath::Abs(ReleaseVelocity) / Params.WobbleFrequency;
+	TestTrue(TEXT("Hover Holds Altitude"), MaxAltitude - ReleaseAltitude <= MaxWobble && ReleaseAltitude - MinAltitude <= MaxWobble);
+	TestTrue(TEXT("Wobble Dies out"), FMath::Abs(State.Velocity.Z) < 1.0f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVehicleMovementModelDecelerationTest, "AerialCombat.Movement.Model.Deceleration",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FVehicleMovementModelDecelerationTest::RunTest(const FString& Parameters)
+{
+	const FVehicleMovementParams Params;
+	FVehicleMoveInput Cruise;
+	Cruise.InputForward = 1.0f;
+	Cruise.InputSteering = 1.0f;
+
+	FVehicleMovementState State = VehicleMovementModelTest::Fly(Params, FVehicleMovementState(), Cruise, 300);
+	TestTrue(TEXT("Moving before Release"), State.Velocity.Size() > 0.0f && State.YawVelocity > 0.0f);
+
+	// Slows down every Step after the Inputs are Released, and Comes to Rest
+	const FVehicleMoveInput NoInput;
+	bool bAlwaysSlower = true;
+	for (int32 Step = 0; Step < 600; ++Step)
+	{
+		const FVehicleMovementState Next = FVehicleMovementModel::Step(Params, State, NoInput);
+		bAlwaysSlower &= Next.Velocity.Size() < State.Velocity.Size() && FMath::Abs(Next.YawVelocity) < FMath::Abs(State.YawVelocity);
+		State = Next;
+	}
+	TestTrue(TEXT("Deceleration Slows every Step"), bAlwaysSlower);
+	TestTrue(TEXT("Comes to Rest"), State.Velocity.Size() < 1.0f);
+	TestTrue(TEXT("Stops Turning"), FMath::Abs(State.YawVelocity) < 0.1f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVehicleMovementModelSteeringTest, "AerialCombat.Movement.Model.Steering",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FVehicleMovementModelSteeringTest::RunTest(const FString& Parameters)
+{
+	const FVehicleMovementParams Params;
+	FVehicleMoveInput Right;
+	Right.InputSteering = 1.0f;
+	FVehicleMoveInput Left;
+	Left.InputSteering = -1.0f;
+
+	FVehicleMovementState State = VehicleMovementModelTest::Fly(Params, FVehicleMovementState(), Right, 60);
+	TestTrue(TEXT("Right Steering Yaws Right"), State.Rotation.Yaw > 0.0f && State.YawVelocity > 0.0f);
+	TestTrue(TEXT("Turns on the Spot"), State.Location.IsNearlyZero());
+
+	State = VehicleMovementModelTest::Fly(Params, FVehicleMovementState(), Left, 60);
+	TestTrue(TEXT("Left Steering Yaws Left"), State.Rotation.Yaw < 0.0f && State.YawVelocity < 0.0f);
+
+	State = VehicleMovementModelTest::Fly(Params, FVehicleMovementState(), Right, 600);
+	TestTrue(TEXT("Held at MaxTurningSpeed"), State.YawVelocity <= Params.MaxTurningSpeed + Params.TurningTorque * Params.FixedStepSeconds);
+
+	// Thrust while Turning Curves the Path
+	FVehicleMoveInput Carve = Right;
+	Carve.InputForward = 1.0f;
+	State = VehicleMovementModelTest::Fly(Params, FVehicleMovementState(), Carve, 120);
+	TestTrue(TEXT("Thrust Follows the Heading"), State.Location.X > 0.0 && State.Location.Y > 0.0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVehicleMovementModelDeterminismTest, "AerialCombat.Movement.Model.Determinism",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FVehicleMovementModelDeterminismTest::RunTest(const FString& Parameters)
+{
+	const FVehicleMovementParams Params;
+	constexpr int32 NumSteps = 600;
+
+	// The Client's Prediction, Straight through
+	FVehicleMovementState Straight;
+	for (int32 Step = 0; Step < NumSteps; ++Step)
+	{
+		const FNetClientMove Move = VehicleMovementModelTest::MakeMove(VehicleMovementModelTest::MakeInput(Step));
+		Straight = FVehicleMovementModel::Step(Params, Straight, ACombatVehicle::MakeMoveInput(Move));
+	}
+
+	// The Server's, Split into Runs with the State Saved and Loaded between them (a Replay Resumes from a Stored State),
+	// Stepping the Moves as they Arrive
+	for (const int32 RunSteps : { 1, 7, 60, 599 })
+	{
+		FVehicleMovementState Split;
+		for (int32 Step = 0; Step < NumSteps; ++Step)
+		{
+			if (Step % RunSteps == 0)
+			{
+				Split = VehicleMovementModelTest::SaveAndLoad(Split);
+			}
+			const FNetClientMove Move = VehicleMovementModelTest::SendMove(VehicleMovementModelTest::MakeMove(VehicleMovementModelTest::MakeInput(Step)));
+			Split = FVehicleMovementModel::Step(Params, Split, ACombatVehicle::MakeMoveInput(Move));
+		}
+
+		TestTrue(FString::Printf(TEXT("Location Matches (Runs of %d)"), RunSteps), Split.Location.Equals(Straight.Location, 0.0));
+		TestTrue(FString::Printf(TEXT("Rotation Matches (Runs of %d)"), RunSteps), Split.Rotation.Equals(Straight.Rotation, 0.0f));
+		TestTrue(FString::Printf(TEXT("Velocity Matches (Runs of %d)"), RunSteps), Split.Velocity.Equals(Straight.Velocity, 0.0));
+		TestEqual(FString::Printf(TEXT("Yaw Velocity Matches (Runs of %d)"), RunSteps), Split.YawVelocity, Straight.YawVelocity);
+		TestEqual(FString::Printf(TEXT("Hover Time Matches (Runs of %d)"), RunSteps), Split.HoverTime, Straight.HoverTime);
+	}
+	return true;
+}
+
+// One Server Tick of 10,000 Vehicles. Only the Model is Timed, the Static Geometry Sweep in ACombatVehicle is not.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVehicleMovementModelBenchmarkTest, "AerialCombat.Movement.Model.Benchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FVehicleMovementModelBenchmarkTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumVehicles = 10000;
+	constexpr int32 NumTicks = 60;
+
+	const FVehicleMovementParams Params;
+	TArray<FVehicleMovementState> States;
+	States.SetNum(NumVehicles);
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+	{
+		for (int32 i = 0; i < NumVehicles; ++i)
+		{
+			States[i] = FVehicleMovementModel::Step(Params, States[i], VehicleMovementModelTest::MakeInput(Tick + i));
+		}
+	}
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	AddInfo(FString::Printf(TEXT("%d Vehicles: %.3f ms per Tick, %.1f ns per Step"),
+		NumVehicles, Seconds * 1000.0 / NumTicks, Seconds * 1e9 / (NumTicks * NumVehicles)));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
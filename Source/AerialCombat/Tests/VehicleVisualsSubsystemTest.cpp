@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Components/PrimitiveComponent.h"
+#include "CombatVehicle.h"
+#include "VehicleVisualsSubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// A Full Match on Screen: 64 Vehicles Registered with the Visuals Subsystem, Locking in and Taking Hits, in a Game World
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVehicleVisualsSubsystemBenchmarkTest, "AerialCombat.Visuals.Subsystem.Benchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FVehicleVisualsSubsystemBenchmarkTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumVehicles = 64;
+	constexpr int32 NumFrames = 600;
+	constexpr float DeltaTime = 1.0f / 60.0f;
+
+	UClass* VehicleClass = LoadClass<ACombatVehicle>(nullptr, TEXT("/Game/Blueprints/BP_CombatVehicle.BP_CombatVehicle_C"));
+	if (!VehicleClass)
+	{
+		AddError(TEXT("BP_CombatVehicle not Found"));
+		return false;
+	}
+
+	// Standalone Game World, so the Subsystem is Created and the Vehicles Register in their BeginPlay
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("VehicleVisualsBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	TArray<ACombatVehicle*> Vehicles;
+	for (int32 i = 0; i < NumVehicles; ++i)
+	{
+		const FVector Location((i % 8) * 2000.0, (i / 8) * 2000.0, 1000.0);
+		if (ACombatVehicle* Vehicle = World->SpawnActor<ACombatVehicle>(VehicleClass, Location, FRotator::ZeroRotator))
+		{
+			Vehicles.Add(Vehicle);
+		}
+	}
+
+	UVehicleVisualsSubsystem* Visuals = World->GetSubsystem<UVehicleVisualsSubsystem>();
+	TestNotNull(TEXT("Visuals Subsystem Created"), Visuals);
+	TestEqual(TEXT("Every Vehicle Registered"), Visuals ? Visuals->GetNumVehicles() : 0, NumVehicles);
+
+	if (Visuals && Visuals->GetNumVehicles() == NumVehicles)
+	{
+		const FVehicleVisualsStats StatsBefore = Visuals->GetStats();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			const double Now = World->GetTimeSeconds();
+			for (int32 i = 0; i < Vehicles.Num(); ++i)
+			{
+				// Nothing Renders here, Count every Vehicle as on Screen so its Changes are Pushed
+				Vehicles[i]->ForEachComponent<UPrimitiveComponent>(false, [Now](UPrimitiveComponent* Component)
+				{
+					Component->SetLastRenderTime(static_cast<float>(Now));
+				});
+
+				// A Quarter Locked in at any Time, a few Hits a Frame
+				Vehicles[i]->bIsLockedIn = ((i + Frame / 60) % 4) == 0;
+				if ((i + Frame) % 16 == 0)
+				{
+					Visuals->PlayHitEffect(Vehicles[i]);
+				}
+			}
+
+			World->Tick(LEVELTICK_All, DeltaTime);
+		}
+
+		const FVehicleVisualsStats& Stats = Visuals->GetStats();
+		const int64 NumTicked = Stats.NumFrames - StatsBefore.NumFrames;
+		const double Milliseconds = FPlatformTime::ToMilliseconds64(Stats.TotalCycles - StatsBefore.TotalCycles);
+		const int64 NumPushes = (Stats.NumScalePushes + Stats.NumColorPushes + Stats.NumHitEffectPushes)
+			- (StatsBefore.NumScalePushes + StatsBefore.NumColorPushes + StatsBefore.NumHitEffectPushes);
+
+		TestEqual(TEXT("Subsystem Ticked every Frame"), NumTicked, static_cast<int64>(NumFrames));
+		if (NumTicked > 0)
+		{
+			AddInfo(FString::Printf(TEXT("%d Vehicles: %.3f ms per Frame (%.2f us per Vehicle), %.1f Pushes and %.1f Skipped per Frame"),
+				NumVehicles, Milliseconds / NumTicked, Milliseconds * 1000.0 / (NumTicked * NumVehicles),
+				static_cast<double>(NumPushes) / NumTicked, static_cast<double>(Stats.NumSkippedPushes - StatsBefore.NumSkippedPushes) / NumTicked));
+		}
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
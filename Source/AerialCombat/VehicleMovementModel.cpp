@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VehicleMovementModel.h"
+
+FVehicleMovementState FVehicleMovementModel::Step(const FVehicleMovementParams& Params, const FVehicleMovementState& InState, const FVehicleMoveInput& Input)
+{
+	const float DeltaTime = Params.FixedStepSeconds;
+	const FVector Forward = InState.Rotation.Vector();
+
+	FVehicleMovementState State = InState;
+
+	FVector Acc = FVector::ZeroVector;
+	float YawAcc = 0.0f;
+
+	// Ascending/Descending
+	bool bHover = true;
+	if (FMath::Abs(Input.InputVertical) > 0.0f)
+	{
+		float MaxVerticalVelocity = Input.InputVertical > 0.0f ? Params.MaxAscentVelocity : Params.MaxDescentVelocity;
+		float VerticalAcc = Input.InputVertical > 0.0f ? Params.AscentAcceleration : Params.DescentAcceleration;
+
+		if (State.Velocity.Z > MaxVerticalVelocity)
+		{
+			State.Velocity.Z = MaxVerticalVelocity;
+		}
+		else
+		{
+			Acc.Z += VerticalAcc;
+		}
+
+		// Hovering will Wobble from this Velocity once the Input is Released
+		State.HoverMaxVelocity = State.Velocity.Z;
+		State.HoverTime = 0.0f;
+		bHover = false;
+	}
+
+	// Forward Movement (with Boost)
+	const bool bBoost = Input.InputBoost > 0.0f;
+	bool bMoving = false;
+
+	if (Input.InputForward > 0.0f)
+	{
+		float UseMaxVel = bBoost ? Params.BoostModeMaxVelocity : Params.MaxMovementVelocity;
+		float UseAcc = bBoost ? Params.BoostModeAcceleration : Params.MovementAcceleration;
+		if (State.Velocity.SquaredLength() > UseMaxVel * UseMaxVel && State.Velocity.Dot(Forward) > 0.0f)
+		{
+			State.Velocity.X = UseMaxVel * Forward.X;
+			State.Velocity.Y = UseMaxVel * Forward.Y;
+		}
+		else
+		{
+			Acc += UseAcc * Forward;
+		}
+
+		bMoving = true;
+	}
+	else if (Input.InputForward < 0.0f) // Backward Movement
+	{
+		FVector Vel(State.Velocity);
+		Vel.Z = 0.0f;
+
+		if (Vel.SquaredLength() > Params.MaxMovementVelocity * Params.MaxMovementVelocity && Vel.Dot(-Forward) > 0.0f)
+		{
+			State.Velocity.X = -Params.MaxMovementVelocity * Forward.X;
+			State.Velocity.Y = -Params.MaxMovementVelocity * Forward.Y;
+		}
+		else
+		{
+			Acc += -Params.MovementAcceleration * Forward;
+		}
+
+		bMoving = true;
+	}
+
+	// Steering
+	bool bTurning = false;
+	if (FMath::Abs(Input.InputSteering) > 0.0f)
+	{
+		if (FMath::Abs(State.YawVelocity) > Params.MaxTurningSpeed)
+		{
+			State.YawVelocity = Input.InputSteering > 0.0f ? Params.MaxTurningSpeed : -Params.MaxTurningSpeed;
+		}
+		else
+		{
+			YawAcc += Input.InputSteering > 0.0f ? Params.TurningTorque : -Params.TurningTorque;
+		}
+
+		bTurning = true;
+	}
+
+	// Hovering
+	if (bHover)
+	{
+		State.HoverTime += DeltaTime;
+
+		// Damped Cosine Wave
+		State.Velocity.Z = Params.WobbleAmplitude * FMath::Exp(-Params.WobbleDecayConst * State.HoverTime) * FMath::Cos(Params.WobbleFrequency * State.HoverTime) * State.HoverMaxVelocity;
+	}
+
+	// Decelerating Forward/Backward Movement and Rotation
+	if (!bMoving)
+	{
+		Acc.X -= State.Velocity.X * Params.DecelerateFactor;
+		Acc.Y -= State.Velocity.Y * Params.DecelerateFactor;
+	}
+	if (!bTurning)
+	{
+		YawAcc -= State.YawVelocity * Params.DecelerateFactor;
+	}
+
+	// Integrate (Semi-Implicit Euler)
+	State.Velocity += Acc * DeltaTime;
+	State.YawVelocity += YawAcc * DeltaTime;
+
+	State.Location += State.Velocity * DeltaTime;
+	State.Rotation.Pitch = Input.BoostPitch;
+	State.Rotation.Roll = Input.BoostRoll;
+	State.Rotation.Yaw = FRotator::NormalizeAxis(State.Rotation.Yaw + State.YawVelocity * DeltaTime);
+
+	return State;
+}
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Tunable Parameters of the Vehicle (Filled from ACombatVehicle's Properties)
+struct FVehicleMovementParams
+{
+	float AscentAcceleration = 200.0f;
+	float MaxAscentVelocity = 250.0f;
+	float DescentAcceleration = -100.0f;
+	float MaxDescentVelocity = -150.0f;
+
+	float MovementAcceleration = 250.0f;
+	float MaxMovementVelocity = 500.0f;
+	float BoostModeAcceleration = 2500.0f;
+	float BoostModeMaxVelocity = 5000.0f;
+
+	float DecelerateFactor = 2.5f;
+	float TurningTorque = 20.0f; // Degrees per Second Squared
+	float MaxTurningSpeed = 40.0f; // Degrees per Second
+
+	float WobbleAmplitude = 1.0f;
+	float WobbleDecayConst = 0.5f;
+	float WobbleFrequency = 2.5f;
+
+	// Every Step advances the Vehicle by exactly this much Time
+	float FixedStepSeconds = 1.0f / 60.0f;
+};
+
+// Inputs of a Single Step
+struct FVehicleMoveInput
+{
+	float InputVertical = 0.0f; // -1, 0, 1
+	float InputForward = 0.0f; // -1, 0, 1
+	float InputSteering = 0.0f; // -1, 0, 1
+	float InputBoost = 0.0f; // 0, 1
+
+	// Boost Mode Tilt (Yaw is Integrated by the Model)
+	float BoostPitch = 0.0f;
+	float BoostRoll = 0.0f;
+};
+
+// Full Kinematic State of the Vehicle. Stepping the same State with the same Inputs always gives the same Result.
+struct FVehicleMovementState
+{
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+	FVector Velocity = FVector::ZeroVector;
+	float YawVelocity = 0.0f; // Degrees per Second
+
+	// Hover Wobble
+	float HoverTime = 0.0f;
+	float HoverMaxVelocity = 0.0f; // Vertical Velocity when the Vehicle started Hovering
+};
+
+/**
+ * Fixed-timestep kinematic model of the Combat Vehicle (hover, ascent, thrust, boost, steering and deceleration).
+ * It has no dependency on UWorld or the physics engine, so the client, the server and move replay all produce
+ * identical results for identical inputs. The vehicle's MeshComp only mirrors the resulting state.
+ */
+struct AERIALCOMBAT_API FVehicleMovementModel
+{
+	// Advance InState by one Fixed Step
+	static FVehicleMovementState Step(const FVehicleMovementParams& Params, const FVehicleMovementState& InState, const FVehicleMoveInput& Input);
+};
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VehiclePoseHistory.h"
+
+FVehiclePoseHistory::FVehiclePoseHistory()
+{
+	Poses.SetNum(MaxPoses);
+}
+
+void FVehiclePoseHistory::AddPose(const FVehiclePose& Pose)
+{
+	// Overwrite the Oldest Pose when Full
+	int32 Tail = (Head + NumPoses) % MaxPoses;
+	Poses[Tail] = Pose;
+	if (NumPoses < MaxPoses)
+	{
+		++NumPoses;
+	}
+	else
+	{
+		Head = (Head + 1) % MaxPoses;
+	}
+}
+
+bool FVehiclePoseHistory::GetPoseAtTime(double Time, FVehiclePose& OutPose) const
+{
+	if (NumPoses == 0)
+		return false;
+
+	// Older than the History (Rewind is Capped, so this only Happens right after Spawning)
+	if (Time <= GetPose(0).Time)
+	{
+		OutPose = GetPose(0);
+		return true;
+	}
+
+	// Recent Poses are the Common Case, Search Backwards
+	for (int32 i = NumPoses - 1; i > 0; --i)
+	{
+		const FVehiclePose& From = GetPose(i - 1);
+		if (From.Time <= Time)
+		{
+			const FVehiclePose& To = GetPose(i);
+			if (Time >= To.Time)
+			{
+				OutPose = To;
+				return true;
+			}
+
+			const float Alpha = static_cast<float>((Time - From.Time) / (To.Time - From.Time));
+			OutPose.Time = Time;
+			OutPose.Location = FMath::Lerp(From.Location, To.Location, Alpha);
+			OutPose.Rotation = FQuat::Slerp(From.Rotation, To.Rotation, Alpha);
+			return true;
+		}
+	}
+
+	OutPose = GetPose(NumPoses - 1);
+	return true;
+}
+
+const FVehiclePose& FVehiclePoseHistory::GetPose(int32 Index) const
+{
+	check(Index >= 0 && Index < NumPoses);
+	return Poses[(Head + Index) % MaxPoses];
+}
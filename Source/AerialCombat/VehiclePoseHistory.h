@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Collision Pose of a Vehicle at a Server Time
+struct FVehiclePose
+{
+	double Time = 0.0;
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+};
+
+/**
+ * Fixed-size ring buffer of the poses a vehicle had on the server, recorded once per frame. Used to rewind the
+ * vehicle to the time a shooter saw it when validating projectile hits (lag compensation).
+ */
+struct AERIALCOMBAT_API FVehiclePoseHistory
+{
+	static constexpr int32 MaxPoses = 64; // A Bit over One Second at 60 FPS
+
+	FVehiclePoseHistory();
+
+	void AddPose(const FVehiclePose& Pose);
+
+	// Pose at Time, Interpolated between the Recorded Poses around it (Clamped to the Oldest/Newest). Returns false if Empty.
+	bool GetPoseAtTime(double Time, FVehiclePose& OutPose) const;
+
+	int32 GetNumPoses() const { return NumPoses; }
+
+private:
+	// Index 0 is the Oldest Pose
+	const FVehiclePose& GetPose(int32 Index) const;
+
+	TArray<FVehiclePose> Poses;
+	int32 Head = 0;
+	int32 NumPoses = 0;
+};
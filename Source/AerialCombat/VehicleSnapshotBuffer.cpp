@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VehicleSnapshotBuffer.h"
+
+FVehicleSnapshotBuffer::FVehicleSnapshotBuffer()
+{
+	Snapshots.SetNum(MaxSnapshots);
+}
+
+void FVehicleSnapshotBuffer::AddSnapshot(const FVehicleSnapshot& Snapshot, double LocalTime)
+{
+	// Unreliable Updates can Arrive Late, Keep the Buffer Ordered
+	if (NumSnapshots > 0 && Snapshot.Time <= GetSnapshot(NumSnapshots - 1).Time)
+	{
+		++Stats.NumOutOfOrder;
+		return;
+	}
+
+	// Follow the Server's Clock Slowly, so Jitter in Arrival doesn't Move the Render Time
+	// A Large Jump (First Snapshot, Vehicle Stalled or Server Hitched) is taken at once
+	constexpr double ClockSmoothing = 0.05;
+	constexpr double MaxClockError = 0.5;
+	const double NewOffset = Snapshot.Time - LocalTime;
+	if (!bHasClockOffset || FMath::Abs(NewOffset - ClockOffset) > MaxClockError)
+	{
+		ClockOffset = NewOffset;
+		bHasClockOffset = true;
+		++Stats.NumClockResyncs;
+	}
+	else
+	{
+		ClockOffset += (NewOffset - ClockOffset) * ClockSmoothing;
+	}
+
+	// Overwrite the Oldest Snapshot when Full
+	int32 Tail = (Head + NumSnapshots) % MaxSnapshots;
+	Snapshots[Tail] = Snapshot;
+	if (NumSnapshots < MaxSnapshots)
+	{
+		++NumSnapshots;
+	}
+	else
+	{
+		Head = (Head + 1) % MaxSnapshots;
+	}
+
+	++Stats.NumSnapshots;
+}
+
+bool FVehicleSnapshotBuffer::Sample(double RenderTime, float MaxExtrapolationTime, float DeltaTime, FVehicleSnapshot& OutSnapshot)
+{
+	if (NumSnapshots == 0)
+		return false;
+
+	// Still Waiting for the Delay to Cover the First Snapshot
+	const FVehicleSnapshot& Oldest = GetSnapshot(0);
+	if (RenderTime <= Oldest.Time)
+	{
+		OutSnapshot = Oldest;
+		return true;
+	}
+
+	// Interpolate between the Pair around the Render Time
+	for (int32 i = NumSnapshots - 1; i > 0; --i)
+	{
+		const FVehicleSnapshot& From = GetSnapshot(i - 1);
+		if (From.Time <= RenderTime)
+		{
+			const FVehicleSnapshot& To = GetSnapshot(i);
+			if (RenderTime > To.Time)
+				break;
+
+			// Drop Snapshots we will never Render again
+			Head = (Head + i - 1) % MaxSnapshots;
+			NumSnapshots -= i - 1;
+
+			OutSnapshot = Interpolate(From, To, RenderTime);
+			bExtrapolating = false;
+			return true;
+		}
+	}
+
+	// Ran past the Newest Snapshot (Buffer Underrun)
+	if (!bExtrapolating)
+	{
+		++Stats.NumUnderruns;
+		bExtrapolating = true;
+	}
+
+	const FVehicleSnapshot& Newest = GetSnapshot(NumSnapshots - 1);
+	float ExtrapolationTime = static_cast<float>(RenderTime - Newest.Time);
+	if (ExtrapolationTime > MaxExtrapolationTime)
+	{
+		ExtrapolationTime = MaxExtrapolationTime;
+		++Stats.NumFrozenFrames;
+	}
+	else
+	{
+		Stats.TotalExtrapolationTime += DeltaTime;
+	}
+	Stats.MaxExtrapolationTime = FMath::Max(Stats.MaxExtrapolationTime, ExtrapolationTime);
+
+	OutSnapshot = Extrapolate(Newest, ExtrapolationTime);
+	return true;
+}
+
+const FVehicleSnapshot& FVehicleSnapshotBuffer::GetSnapshot(int32 Index) const
+{
+	check(Index >= 0 && Index < NumSnapshots);
+	return Snapshots[(Head + Index) % MaxSnapshots];
+}
+
+FVehicleSnapshot FVehicleSnapshotBuffer::Interpolate(const FVehicleSnapshot& From, const FVehicleSnapshot& To, double Time)
+{
+	const float Duration = static_cast<float>(To.Time - From.Time);
+	const float Alpha = static_cast<float>((Time - From.Time) / Duration);
+
+	// Cubic Hermite with the Velocities as Tangents (Scaled to the Interval)
+	FVehicleSnapshot Result;
+	Result.Time = Time;
+	Result.Location = FMath::CubicInterp(From.Location, From.Velocity * Duration, To.Location, To.Velocity * Duration, Alpha);
+	Result.Velocity = FMath::CubicInterpDerivative(From.Location, From.Velocity * Duration, To.Location, To.Velocity * Duration, Alpha) / Duration;
+	Result.Rotation = FMath::Lerp(From.Rotation, To.Rotation, Alpha); // Shortest Path
+	Result.YawVelocity = FMath::Lerp(From.YawVelocity, To.YawVelocity, Alpha);
+
+	return Result;
+}
+
+FVehicleSnapshot FVehicleSnapshotBuffer::Extrapolate(const FVehicleSnapshot& From, float ExtrapolationTime)
+{
+	FVehicleSnapshot Result = From;
+	Result.Time = From.Time + ExtrapolationTime;
+	Result.Location += From.Velocity * ExtrapolationTime;
+	Result.Rotation.Yaw = FRotator::NormalizeAxis(From.Rotation.Yaw + From.YawVelocity * ExtrapolationTime);
+
+	return Result;
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Movement State of a Remote Vehicle at the Server Time it was Simulated
+struct FVehicleSnapshot
+{
+	double Time = 0.0; // Server Simulation Time (Acknowledged Move Sequence * Fixed Step)
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+	FVector Velocity = FVector::ZeroVector;
+	float YawVelocity = 0.0f; // Degrees per Second
+};
+
+struct FVehicleSnapshotStats
+{
+	int32 NumSnapshots = 0;
+	int32 NumOutOfOrder = 0; // Dropped, not Newer than the Newest Snapshot
+	int32 NumUnderruns = 0; // Times the Render Time ran past the Newest Snapshot
+	int32 NumFrozenFrames = 0; // Frames spent past the Extrapolation Limit
+	int32 NumClockResyncs = 0; // Server Clock Offset Jumped (First Snapshot, Long Stall or Hitch)
+	double TotalExtrapolationTime = 0.0;
+	float MaxExtrapolationTime = 0.0f;
+};
+
+/**
+ * Ring buffer of timestamped snapshots for a simulated proxy. Snapshots carry the server's simulation time, so
+ * network jitter doesn't bend their spacing; the buffer tracks a smoothed offset from the local clock to it.
+ * The proxy is rendered at (ServerTime - InterpolationDelay) by Hermite interpolating between the two snapshots
+ * around that time, using the replicated velocities as tangents.
+ * When the render time runs past the newest snapshot (lost or late packets), the state is extrapolated with the
+ * newest velocity for a bounded time and then held.
+ */
+struct AERIALCOMBAT_API FVehicleSnapshotBuffer
+{
+	static constexpr int32 MaxSnapshots = 32;
+
+	FVehicleSnapshotBuffer();
+
+	// LocalTime is the Receive Time, only used to Track the Offset to the Server's Clock
+	void AddSnapshot(const FVehicleSnapshot& Snapshot, double LocalTime);
+
+	// Local Time in the Snapshots' Timebase
+	double GetServerTime(double LocalTime) const { return LocalTime + ClockOffset; }
+
+	// Returns false if there is nothing to Sample yet
+	bool Sample(double RenderTime, float MaxExtrapolationTime, float DeltaTime, FVehicleSnapshot& OutSnapshot);
+
+	int32 GetNumSnapshots() const { return NumSnapshots; }
+
+	const FVehicleSnapshotStats& GetStats() const { return Stats; }
+
+private:
+	// Index 0 is the Oldest Snapshot
+	const FVehicleSnapshot& GetSnapshot(int32 Index) const;
+
+	static FVehicleSnapshot Interpolate(const FVehicleSnapshot& From, const FVehicleSnapshot& To, double Time);
+	static FVehicleSnapshot Extrapolate(const FVehicleSnapshot& From, float ExtrapolationTime);
+
+	TArray<FVehicleSnapshot> Snapshots;
+	int32 Head = 0;
+	int32 NumSnapshots = 0;
+
+	// Server Time minus Local Time
+	double ClockOffset = 0.0;
+	bool bHasClockOffset = false;
+
+	bool bExtrapolating = false;
+	FVehicleSnapshotStats Stats;
+};
@@ -0,0 +1,292 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VehicleVisualsSubsystem.h"
+#include "AerialCombat.h"
+#include "CombatVehicle.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+DECLARE_CYCLE_STAT(TEXT("Vehicle Visuals Tick"), STAT_VehicleVisualsTick, STATGROUP_AerialCombat);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Vehicle Visuals"), STAT_VehicleVisuals, STATGROUP_AerialCombat);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Vehicle Visual Pushes"), STAT_VehicleVisualPushes, STATGROUP_AerialCombat);
+
+bool UVehicleVisualsSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UVehicleVisualsSubsystem::Deinitialize()
+{
+	if (Stats.NumFrames > 0)
+	{
+		UE_LOG(LogAerialCombat, Log, TEXT("Vehicle visuals: %.1fus per frame for up to %d vehicles (%.2fus per vehicle), %lld scale, %lld color, %lld hit effect pushes, %lld effect updates, %lld pushes skipped."),
+			FPlatformTime::ToMilliseconds64(Stats.TotalCycles) * 1000.0 / Stats.NumFrames, Stats.PeakVehicles,
+			Stats.NumVehicleUpdates > 0 ? FPlatformTime::ToMilliseconds64(Stats.TotalCycles) * 1000.0 / Stats.NumVehicleUpdates : 0.0,
+			Stats.NumScalePushes, Stats.NumColorPushes, Stats.NumHitEffectPushes, Stats.NumEffectUpdates, Stats.NumSkippedPushes);
+	}
+
+	Super::Deinitialize();
+}
+
+TStatId UVehicleVisualsSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UVehicleVisualsSubsystem, STATGROUP_Tickables);
+}
+
+void UVehicleVisualsSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VehicleVisualsTick);
+	SET_DWORD_STAT(STAT_VehicleVisuals, Vehicles.Num());
+
+	if (Vehicles.Num() == 0)
+		return;
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const int64 NumPushesBefore = Stats.NumScalePushes + Stats.NumColorPushes + Stats.NumHitEffectPushes;
+
+	GatherInputs();
+	UpdateLightRidges(DeltaTime);
+	UpdateHitEffects(DeltaTime);
+	PushChanges();
+
+	SET_DWORD_STAT(STAT_VehicleVisualPushes, Stats.NumScalePushes + Stats.NumColorPushes + Stats.NumHitEffectPushes - NumPushesBefore);
+
+	++Stats.NumFrames;
+	Stats.NumVehicleUpdates += Vehicles.Num();
+	Stats.TotalCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+void UVehicleVisualsSubsystem::RegisterVehicle(ACombatVehicle* Vehicle)
+{
+	if (!Vehicle || Vehicle->VisualsIndex != INDEX_NONE)
+		return;
+
+	FVehicleVisualSettings& VehicleSettings = Settings.AddDefaulted_GetRef();
+	VehicleSettings.LightRidgeColorStart = Vehicle->LightRidgeColorStart;
+	VehicleSettings.LightRidgeColorEnd = Vehicle->LightRidgeColorEnd;
+	VehicleSettings.LightRidgeLockInColor = Vehicle->LightRidgeLockInColor;
+	VehicleSettings.LightRidgeLockInFadeFactor = Vehicle->LightRidgeLockInFadeFactor;
+	// Cycle Indices are only Initialized if the Material Exposes the Cycle Parameters (see ACombatVehicle::BeginPlay)
+	VehicleSettings.bLightRidgeCycleInMaterial = Vehicle->LightRidgeCycleBlendIndex != INDEX_NONE && Vehicle->LightRidgeCycleStartIndex != INDEX_NONE;
+	VehicleSettings.HitEffectFadeFactor = Vehicle->HitEffectFadeFactor;
+	VehicleSettings.MaxAscentVelocity = Vehicle->MaxAscentVelocity;
+	VehicleSettings.MaxDescentVelocity = Vehicle->MaxDescentVelocity;
+	VehicleSettings.JetFlameCenterScale = Vehicle->JetFlameCenterScale;
+	VehicleSettings.JetFlameRightScale = Vehicle->JetFlameRightScale;
+	VehicleSettings.JetFlameLeftScale = Vehicle->JetFlameLeftScale;
+
+	Vehicle->VisualsIndex = Vehicles.Add(Vehicle);
+	VelocitiesZ.Add(0.0f);
+	LockedIn.Add(0);
+	EffectFlags.Add(0);
+	AppliedEffectFlags.Add(MAX_uint8); // Applied on the First Frame
+	LightRidgeCycleStartTimes.Add(GetWorld()->GetTimeSeconds());
+	LightRidgeCycling.Add(1);
+	LightRidgeLockInTimers.Add(0.0f);
+	ActiveLightRidgeColors.Add(VehicleSettings.LightRidgeColorStart);
+	LightRidgeColors.Add(VehicleSettings.LightRidgeColorStart);
+	PushedLightRidgeColors.Add(FLinearColor(-1.0f, -1.0f, -1.0f, -1.0f)); // Never Pushed
+	PushedLightRidgeCycleBlends.Add(0.0f);
+	PushedLightRidgeCycleStartTimes.Add(0.0);
+	PushedJetFlameScales.Add(1.0f); // Meshes Start at their Base Scale
+	HitEffectAlphas.Add(0.0f);
+	PushedHitEffectAlphas.Add(0.0f);
+
+	Stats.PeakVehicles = FMath::Max(Stats.PeakVehicles, Vehicles.Num());
+}
+
+void UVehicleVisualsSubsystem::UnregisterVehicle(ACombatVehicle* Vehicle)
+{
+	if (!Vehicle || !Vehicles.IsValidIndex(Vehicle->VisualsIndex) || Vehicles[Vehicle->VisualsIndex] != Vehicle)
+		return;
+
+	RemoveVehicle(Vehicle->VisualsIndex);
+	Vehicle->VisualsIndex = INDEX_NONE;
+}
+
+void UVehicleVisualsSubsystem::PlayHitEffect(const ACombatVehicle* Vehicle)
+{
+	if (Vehicle && Vehicles.IsValidIndex(Vehicle->VisualsIndex))
+	{
+		HitEffectAlphas[Vehicle->VisualsIndex] = 1.0f;
+	}
+}
+
+void UVehicleVisualsSubsystem::RemoveVehicle(int32 Index)
+{
+	Vehicles.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Settings.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	VelocitiesZ.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	LockedIn.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	EffectFlags.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	AppliedEffectFlags.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	LightRidgeCycleStartTimes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	LightRidgeCycling.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	LightRidgeLockInTimers.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	ActiveLightRidgeColors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	LightRidgeColors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	PushedLightRidgeColors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	PushedLightRidgeCycleBlends.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	PushedLightRidgeCycleStartTimes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	PushedJetFlameScales.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	HitEffectAlphas.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	PushedHitEffectAlphas.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	// The Last Vehicle took this Slot
+	if (Vehicles.IsValidIndex(Index) && Vehicles[Index])
+	{
+		Vehicles[Index]->VisualsIndex = Index;
+	}
+}
+
+void UVehicleVisualsSubsystem::GatherInputs()
+{
+	for (int32 i = 0; i < Vehicles.Num(); ++i)
+	{
+		const ACombatVehicle* Vehicle = Vehicles[i];
+		VelocitiesZ[i] = Vehicle->GetVelocity().Z;
+		LockedIn[i] = Vehicle->bIsLockedIn ? 1 : 0;
+
+		// Remote Vehicles Apply their Flags when they Replicate (see ACombatVehicle::ApplyVisualState)
+		EffectFlags[i] = Vehicle->IsLocallyControlled() ? Vehicle->GatherClientVisuals().Flags : AppliedEffectFlags[i];
+	}
+}
+
+void UVehicleVisualsSubsystem::UpdateLightRidges(float DeltaTime)
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	for (int32 i = 0; i < Vehicles.Num(); ++i)
+	{
+		const FVehicleVisualSettings& VehicleSettings = Settings[i];
+
+		if (!LockedIn[i])
+		{
+			// Fade back to Starting Color if recently Locked In
+			if (LightRidgeLockInTimers[i] > 0.0f)
+			{
+				LightRidgeColors[i] = FMath::Lerp(VehicleSettings.LightRidgeColorStart, VehicleSettings.LightRidgeLockInColor, LightRidgeLockInTimers[i]); // Lerp Backwards
+				LightRidgeCycleStartTimes[i] = Now;
+				LightRidgeCycling[i] = 0;
+				LightRidgeLockInTimers[i] -= DeltaTime * VehicleSettings.LightRidgeLockInFadeFactor;
+			}
+			else
+			{
+				// Proceed with Normal Color Cycle (Same Curve as the Material's)
+				const float LerpFactor = FMath::Abs(FMath::Sin(static_cast<float>(Now - LightRidgeCycleStartTimes[i])));
+				LightRidgeColors[i] = FMath::Lerp(VehicleSettings.LightRidgeColorStart, VehicleSettings.LightRidgeColorEnd, LerpFactor);
+				ActiveLightRidgeColors[i] = LightRidgeColors[i];
+				LightRidgeCycling[i] = 1;
+				LightRidgeLockInTimers[i] = 0.0f;
+			}
+		}
+		else
+		{
+			// Fade to the Specified Lock In Color
+			LightRidgeLockInTimers[i] = FMath::Min(LightRidgeLockInTimers[i] + DeltaTime * VehicleSettings.LightRidgeLockInFadeFactor, 1.0f);
+			LightRidgeColors[i] = FMath::Lerp(ActiveLightRidgeColors[i], VehicleSettings.LightRidgeLockInColor, LightRidgeLockInTimers[i]);
+			LightRidgeCycling[i] = 0;
+		}
+	}
+}
+
+void UVehicleVisualsSubsystem::UpdateHitEffects(float DeltaTime)
+{
+	for (int32 i = 0; i < Vehicles.Num(); ++i)
+	{
+		HitEffectAlphas[i] = FMath::Max(HitEffectAlphas[i] - DeltaTime * Settings[i].HitEffectFadeFactor, 0.0f);
+	}
+}
+
+void UVehicleVisualsSubsystem::PushChanges()
+{
+	for (int32 i = 0; i < Vehicles.Num(); ++i)
+	{
+		ACombatVehicle* Vehicle = Vehicles[i];
+		const FVehicleVisualSettings& VehicleSettings = Settings[i];
+
+		// Flame and Trail Effects only Change with the Input Flags
+		if (EffectFlags[i] != AppliedEffectFlags[i])
+		{
+			Vehicle->SetSpeedTrailVisuals();
+			Vehicle->SetThrustFlameVisuals();
+			Vehicle->SetTurningFlameVisuals();
+			AppliedEffectFlags[i] = EffectFlags[i];
+			++Stats.NumEffectUpdates;
+		}
+
+		// Hit Effect is a Post Process on the Vehicle's own Camera
+		if (HitEffectAlphas[i] != PushedHitEffectAlphas[i] && Vehicle->HitEffectMaterial)
+		{
+			Vehicle->HitEffectMaterial->SetScalarParameterByIndex(Vehicle->HitEffectAlphaIndex, HitEffectAlphas[i]);
+			PushedHitEffectAlphas[i] = HitEffectAlphas[i];
+			++Stats.NumHitEffectPushes;
+		}
+
+		// Nobody Sees the Meshes, Catch up once back on Screen
+		if (!Vehicle->IsLocallyControlled() && !Vehicle->WasRecentlyRendered())
+		{
+			Stats.NumSkippedPushes += 2;
+			continue;
+		}
+
+		// Jet Flames Stretch with Vertical Speed
+		const float VelZ = VelocitiesZ[i];
+		const float JetFlameScale = 1.0f + (VelZ > 0.0f ? VelZ / VehicleSettings.MaxAscentVelocity : -VelZ / VehicleSettings.MaxDescentVelocity);
+		if (!FMath::IsNearlyEqual(JetFlameScale, PushedJetFlameScales[i], JetFlameScaleTolerance))
+		{
+			Vehicle->JetFlameCenterMeshComp->SetRelativeScale3D(VehicleSettings.JetFlameCenterScale * FVector(1.0f, 1.0f, JetFlameScale));
+			Vehicle->JetFlameRightMeshComp->SetRelativeScale3D(VehicleSettings.JetFlameRightScale * FVector(1.0f, 1.0f, JetFlameScale));
+			Vehicle->JetFlameLeftMeshComp->SetRelativeScale3D(VehicleSettings.JetFlameLeftScale * FVector(1.0f, 1.0f, JetFlameScale));
+			PushedJetFlameScales[i] = JetFlameScale;
+			++Stats.NumScalePushes;
+		}
+		else
+		{
+			++Stats.NumSkippedPushes;
+		}
+
+		if (Vehicle->LightRidgeMaterial)
+		{
+			PushLightRidge(i);
+		}
+	}
+}
+
+void UVehicleVisualsSubsystem::PushLightRidge(int32 Index)
+{
+	UMaterialInstanceDynamic* LightRidgeMaterial = Vehicles[Index]->LightRidgeMaterial;
+	const int64 NumPushesBefore = Stats.NumColorPushes;
+
+	// The Material Cycles by itself, only Restarts are Sent
+	const bool bCycleInMaterial = Settings[Index].bLightRidgeCycleInMaterial && LightRidgeCycling[Index];
+	if (Settings[Index].bLightRidgeCycleInMaterial)
+	{
+		const float CycleBlend = bCycleInMaterial ? 1.0f : 0.0f;
+		if (CycleBlend != PushedLightRidgeCycleBlends[Index])
+		{
+			LightRidgeMaterial->SetScalarParameterByIndex(Vehicles[Index]->LightRidgeCycleBlendIndex, CycleBlend);
+			PushedLightRidgeCycleBlends[Index] = CycleBlend;
+			++Stats.NumColorPushes;
+		}
+
+		if (bCycleInMaterial && LightRidgeCycleStartTimes[Index] != PushedLightRidgeCycleStartTimes[Index])
+		{
+			LightRidgeMaterial->SetScalarParameterByIndex(Vehicles[Index]->LightRidgeCycleStartIndex, static_cast<float>(LightRidgeCycleStartTimes[Index]));
+			PushedLightRidgeCycleStartTimes[Index] = LightRidgeCycleStartTimes[Index];
+			++Stats.NumColorPushes;
+		}
+	}
+
+	if (!bCycleInMaterial && !LightRidgeColors[Index].Equals(PushedLightRidgeColors[Index], LightRidgeColorTolerance))
+	{
+		LightRidgeMaterial->SetVectorParameterByIndex(Vehicles[Index]->LightRidgeColorIndex, LightRidgeColors[Index]);
+		PushedLightRidgeColors[Index] = LightRidgeColors[Index];
+		++Stats.NumColorPushes;
+	}
+
+	if (Stats.NumColorPushes == NumPushesBefore)
+	{
+		++Stats.NumSkippedPushes;
+	}
+}
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "VehicleVisualsSubsystem.generated.h"
+
+class ACombatVehicle;
+
+/** Look of a vehicle's time-driven visuals, read once when it registers. */
+struct FVehicleVisualSettings
+{
+	FLinearColor LightRidgeColorStart;
+	FLinearColor LightRidgeColorEnd;
+	FLinearColor LightRidgeLockInColor;
+	float LightRidgeLockInFadeFactor = 1.0f;
+	bool bLightRidgeCycleInMaterial = false;
+	float HitEffectFadeFactor = 1.0f;
+	float MaxAscentVelocity = 1.0f;
+	float MaxDescentVelocity = -1.0f;
+	FVector JetFlameCenterScale;
+	FVector JetFlameRightScale;
+	FVector JetFlameLeftScale;
+};
+
+struct FVehicleVisualsStats
+{
+	int64 NumFrames = 0;
+	int64 NumVehicleUpdates = 0;
+	int64 NumScalePushes = 0;
+	int64 NumColorPushes = 0;
+	int64 NumHitEffectPushes = 0;
+	int64 NumEffectUpdates = 0; // Flame and Trail Effects Re-evaluated after a Flag Change
+	int64 NumSkippedPushes = 0; // Unchanged, or not on Screen
+	uint64 TotalCycles = 0;
+	int32 PeakVehicles = 0;
+};
+
+/**
+ * Client-side update of every vehicle's time-driven visuals in one pass: light ridge color, jet flame scale, hit effect
+ * fade, and (for the local vehicle) the thrust, turning and speed trail effects driven by its input flags.
+ *
+ * The state lives here in a structure-of-arrays buffer instead of on each vehicle. Each frame the inputs are gathered
+ * from the vehicles, the new values are computed over the arrays, and only values that changed are pushed to the
+ * components and materials (material parameters by index). Vehicles that weren't rendered recently skip the push
+ * until they are back on screen. With bLightRidgeCycleInMaterial, the light ridge color cycle runs in the material
+ * and is only pushed when the cycle restarts.
+ */
+UCLASS()
+class AERIALCOMBAT_API UVehicleVisualsSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterVehicle(ACombatVehicle* Vehicle);
+	void UnregisterVehicle(ACombatVehicle* Vehicle);
+
+	/** Flashes the hit effect of a vehicle, fading out over time. */
+	void PlayHitEffect(const ACombatVehicle* Vehicle);
+
+	int32 GetNumVehicles() const { return Vehicles.Num(); }
+
+	const FVehicleVisualsStats& GetStats() const { return Stats; }
+
+private:
+	void GatherInputs();
+	void UpdateLightRidges(float DeltaTime);
+	void UpdateHitEffects(float DeltaTime);
+	void PushChanges();
+	void PushLightRidge(int32 Index);
+
+	void RemoveVehicle(int32 Index);
+
+	UPROPERTY()
+	TArray<TObjectPtr<ACombatVehicle>> Vehicles;
+
+	// Vehicles (Structure of Arrays, same Index in every Array)
+	TArray<FVehicleVisualSettings> Settings;
+	TArray<float> VelocitiesZ;
+	TArray<uint8> LockedIn;
+	TArray<uint8> EffectFlags; // FNetClientVisuals Flags of Local Vehicles
+	TArray<uint8> AppliedEffectFlags;
+	TArray<double> LightRidgeCycleStartTimes; // World Time the Color Cycle (Re)started
+	TArray<uint8> LightRidgeCycling; // In the Color Cycle, not Fading to/from the Lock In Color
+	TArray<float> LightRidgeLockInTimers;
+	TArray<FLinearColor> ActiveLightRidgeColors; // Color when the Vehicle Locked In (Faded from/back to)
+	TArray<FLinearColor> LightRidgeColors;
+	TArray<FLinearColor> PushedLightRidgeColors;
+	TArray<float> PushedLightRidgeCycleBlends;
+	TArray<double> PushedLightRidgeCycleStartTimes;
+	TArray<float> PushedJetFlameScales;
+	TArray<float> HitEffectAlphas;
+	TArray<float> PushedHitEffectAlphas;
+
+	FVehicleVisualsStats Stats;
+
+	// Smaller Changes aren't Visible
+	static constexpr float JetFlameScaleTolerance = 0.005f;
+	static constexpr float LightRidgeColorTolerance = 1.0f / 512.0f;
+};